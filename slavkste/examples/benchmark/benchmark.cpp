@@ -0,0 +1,387 @@
+#include "../../src/levelLoader.hpp"
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <fstream>
+
+/**
+ * Headless physics benchmark.
+ * Loads level, optionally scatters debris circles over it and steps
+ * engine as fast as possible, then prints per-phase timings.
+ * Heap allocations done by steps are counted, second half of frames is taken as steady state.
+ * With -a frames are first stepped once as warm up and level is loaded again, so engine
+ * capacities already cover peaks of measured run, then benchmark fails if any measured step allocated.
+ * With -o positions of objects are written to trace file, with -r they are compared
+ * to trace of other run, to measure drift of single precision build from double build.
+ *
+ * usage: benchmark [-f frames] [-d debris] [-b brute|sap|grid] [-t threads] [-s] [-i iterations] [-w] [-a]
+ *                  [-o trace] [-r trace] level.json
+ */
+
+/**
+ * Number of calls of global operator new.
+ */
+static std::atomic<size_t> allocationCount{ 0 };
+
+void *operator new( size_t size )
+{
+  ++allocationCount;
+  if( void *memory = std::malloc( size ? size : 1 ) )
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete( void *memory ) noexcept
+{
+  std::free( memory );
+}
+
+void operator delete( void *memory, size_t ) noexcept
+{
+  std::free( memory );
+}
+
+/**
+ * Time step used by game. ( CGame::frameLength )
+ */
+static const double timeStep = 0.04;
+
+/**
+ * Positions of objects are traced every traceInterval frames.
+ */
+static const size_t traceInterval = 10;
+
+/**
+ * Traced positions, x and y of all objects in each traced frame.
+ */
+using TTrace = std::vector<std::vector<double>>;
+
+struct TBenchmarkOptions
+{
+  std::string levelFileName = "assets/level_1.json";
+  size_t frames = 1000;
+  size_t debris = 0;
+  std::string broadPhase = "sap";
+  size_t threads = 1;
+  bool sleeping = false;
+  TSolverSettings solver;
+  bool assertNoAllocations = false;
+  std::string traceFileName;
+  std::string referenceFileName;
+};
+
+static void printUsage( const char *name )
+{
+  std::cerr << "usage: " << name << " [-f frames] [-d debris] [-b brute|sap|grid] [-t threads] [-s] [-i iterations] [-w] [-a]"
+               " [-o trace] [-r trace] level.json\n";
+}
+
+static bool parseOptions( int argc, char *argv[], TBenchmarkOptions &options )
+{
+  for( int idx = 1; idx < argc; ++idx )
+  {
+    bool hasValue = idx + 1 < argc;
+    if( !strcmp( argv[ idx ], "-f" ) && hasValue )
+      options.frames = std::stoul( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-d" ) && hasValue )
+      options.debris = std::stoul( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-b" ) && hasValue )
+      options.broadPhase = argv[ ++idx ];
+    else if( !strcmp( argv[ idx ], "-t" ) && hasValue )
+      options.threads = std::stoul( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-s" ) )
+      options.sleeping = true;
+    else if( !strcmp( argv[ idx ], "-i" ) && hasValue )
+      options.solver.velocityIterations = std::stoul( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-w" ) )
+      options.solver.warmStarting = true;
+    else if( !strcmp( argv[ idx ], "-a" ) )
+      options.assertNoAllocations = true;
+    else if( !strcmp( argv[ idx ], "-o" ) && hasValue )
+      options.traceFileName = argv[ ++idx ];
+    else if( !strcmp( argv[ idx ], "-r" ) && hasValue )
+      options.referenceFileName = argv[ ++idx ];
+    else if( argv[ idx ][ 0 ] == '-' )
+      return false;
+    else
+      options.levelFileName = argv[ idx ];
+  }
+  return true;
+}
+
+static std::unique_ptr<CBroadPhase> createBroadPhase( const std::string &name )
+{
+  if( name == "brute" )
+    return std::make_unique<CBruteForceBroadPhase>();
+  if( name == "grid" )
+    return std::make_unique<CUniformGridBroadPhase>();
+  if( name == "sap" )
+    return std::make_unique<CSweepAndPruneBroadPhase>();
+  throw std::invalid_argument( "Unknown broad-phase " + name + ".\n" );
+}
+
+/**
+ * Scatters debris circles over upper part of view. Seed is fixed so runs are comparable.
+ */
+static void addDebris( std::vector<CPhysicsObject *> &objects, const TVector<2> &viewSize, size_t count )
+{
+  std::mt19937 generator( 42 );
+  std::uniform_real_distribution<double> x( viewSize[ 0 ] * 0.1, viewSize[ 0 ] * 0.9 );
+  std::uniform_real_distribution<double> y( viewSize[ 1 ] * 0.3, viewSize[ 1 ] * 0.9 );
+  std::uniform_real_distribution<double> radius( 4, 12 );
+  for( size_t idx = 0; idx < count; ++idx )
+    objects.push_back( new CCircle( { x( generator ), y( generator ) }, radius( generator ), 5 ) );
+}
+
+static void recordTrace( const std::vector<CPhysicsObject *> &objects, TTrace &trace )
+{
+  auto &positions = trace.emplace_back();
+  for( const CPhysicsObject *object: objects )
+  {
+    positions.push_back( object->m_position[ 0 ] );
+    positions.push_back( object->m_position[ 1 ] );
+  }
+}
+
+static void writeTrace( const std::string &fileName, const TTrace &trace )
+{
+  std::ofstream file( fileName );
+  file << std::setprecision( 17 );
+  for( const auto &positions: trace )
+  {
+    file << positions.size();
+    for( double value: positions )
+      file << ' ' << value;
+    file << '\n';
+  }
+  if( !file )
+    throw std::invalid_argument( "Could not write trace " + fileName + ".\n" );
+}
+
+static TTrace readTrace( const std::string &fileName )
+{
+  std::ifstream file( fileName );
+  if( !file )
+    throw std::invalid_argument( "Could not read trace " + fileName + ".\n" );
+  TTrace trace;
+  size_t count;
+  while( file >> count )
+  {
+    auto &positions = trace.emplace_back( count );
+    for( double &value: positions )
+      file >> value;
+  }
+  if( !file.eof() )
+    throw std::invalid_argument( "Invalid trace " + fileName + ".\n" );
+  return trace;
+}
+
+/**
+ * Prints distances of traced positions from reference trace,
+ * mean and max in last traced frame and max over whole run.
+ */
+static void printDrift( const TTrace &trace, const TTrace &reference )
+{
+  if( trace.size() != reference.size() )
+    throw std::invalid_argument( "Reference trace has different number of frames.\n" );
+  double meanDrift = 0, maxDrift = 0, runDrift = 0;
+  for( size_t frame = 0; frame < trace.size(); ++frame )
+  {
+    if( trace[ frame ].size() != reference[ frame ].size() )
+      throw std::invalid_argument( "Reference trace has different number of objects.\n" );
+    size_t objectCount = trace[ frame ].size() / 2;
+    meanDrift = maxDrift = 0;
+    for( size_t object = 0; object < objectCount; ++object )
+    {
+      double drift = std::hypot( trace[ frame ][ 2 * object ] - reference[ frame ][ 2 * object ],
+                                 trace[ frame ][ 2 * object + 1 ] - reference[ frame ][ 2 * object + 1 ] );
+      meanDrift += drift / (double)objectCount;
+      maxDrift = std::max( maxDrift, drift );
+    }
+    runDrift = std::max( runDrift, maxDrift );
+  }
+  std::cout << "drift:        " << meanDrift << " mean, " << maxDrift << " max at end, "
+            << runDrift << " max during run\n";
+}
+
+#ifdef PHYSICS_PROFILING
+static void printPhase( const std::string &name, double total, size_t frames )
+{
+  std::cout << std::left << std::setw( 20 ) << name << std::right
+            << std::setw( 12 ) << total * 1e3
+            << std::setw( 16 ) << total * 1e6 / (double)frames << '\n';
+}
+#endif
+
+int main( int argc, char *argv[] )
+{
+  TBenchmarkOptions options;
+  if( !parseOptions( argc, argv, options ) || !options.frames )
+  {
+    printUsage( argv[ 0 ] );
+    return 1;
+  }
+
+  CWindow window;
+  CPhysicsEngine engine;
+  std::vector<CPhysicsObject *> objects;
+  std::vector<CText *> texts;
+  CPainter painter( [](){} );
+  CLevelLoader loader( window, engine, objects, texts, painter, options.levelFileName );
+
+  try
+  {
+    loader.loadLevel();
+    engine.setBroadPhase( createBroadPhase( options.broadPhase ) );
+    engine.setThreadCount( options.threads );
+    engine.setSleeping( options.sleeping );
+    engine.setSolver( options.solver );
+  }
+  catch( const std::invalid_argument &e )
+  {
+    std::cerr << e.what();
+    return 1;
+  }
+  addDebris( objects, window.getViewSize(), options.debris );
+
+  if( options.assertNoAllocations )
+  {
+    for( size_t frame = 0; frame < options.frames; ++frame )
+      engine.step( objects, timeStep );
+    loader.loadLevel();
+    addDebris( objects, window.getViewSize(), options.debris );
+  }
+
+  TTrace trace, reference;
+  try
+  {
+    if( !options.referenceFileName.empty() )
+      reference = readTrace( options.referenceFileName );
+  }
+  catch( const std::invalid_argument &e )
+  {
+    std::cerr << e.what();
+    return 1;
+  }
+  bool tracing = !options.traceFileName.empty() || !options.referenceFileName.empty();
+
+#ifdef PHYSICS_PROFILING
+  TStepStatistics total;
+  size_t mostManifolds = 0;
+#endif
+  size_t allocations = 0, steadyAllocations = 0, allocatingSteadySteps = 0;
+  auto start = std::chrono::steady_clock::now();
+  for( size_t frame = 0; frame < options.frames; ++frame )
+  {
+    size_t allocationsBefore = allocationCount;
+    engine.step( objects, timeStep );
+    size_t stepAllocations = allocationCount - allocationsBefore;
+    if( tracing && ( frame + 1 ) % traceInterval == 0 )
+      recordTrace( objects, trace );
+    allocations += stepAllocations;
+    if( frame >= options.frames / 2 )
+    {
+      steadyAllocations += stepAllocations;
+      allocatingSteadySteps += stepAllocations != 0;
+    }
+
+#ifdef PHYSICS_PROFILING
+    const auto &stats = engine.lastStep;
+    total.accumulateForces += stats.accumulateForces;
+    total.applyForces += stats.applyForces;
+    for( size_t pass = 0; pass < stats.search.size(); ++pass )
+    {
+      total.search[ pass ].time += stats.search[ pass ].time;
+      total.search[ pass ].pairTests += stats.search[ pass ].pairTests;
+      total.search[ pass ].manifolds += stats.search[ pass ].manifolds;
+    }
+    total.impulses += stats.impulses;
+    total.resolution += stats.resolution;
+    total.contacts += stats.contacts;
+    mostManifolds = std::max( mostManifolds, stats.search[ 0 ].manifolds + stats.search[ 1 ].manifolds );
+#endif
+  }
+  double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  size_t sleeping = std::count_if( objects.begin(), objects.end(), []( const CPhysicsObject *object )
+  {
+    return object->m_sleeping;
+  } );
+
+  std::cout << std::fixed << std::setprecision( 3 )
+            << "level:        " << options.levelFileName << '\n'
+            << "scalar:       " << ( sizeof( TScalar ) == sizeof( float ) ? "float" : "double" ) << '\n'
+            << "objects:      " << objects.size() << '\n'
+            << "broad-phase:  " << options.broadPhase << '\n'
+            << "threads:      " << options.threads << '\n'
+            << "solver:       " << options.solver.velocityIterations << " iterations"
+            << ( options.solver.warmStarting ? ", warm starting" : "" ) << '\n'
+            << "sleeping:     " << ( options.sleeping ? std::to_string( sleeping ) + " objects at end" : "off" ) << '\n'
+            << "frames:       " << options.frames << '\n'
+            << "elapsed [s]:  " << elapsed << '\n'
+            << "steps/s:      " << (double)options.frames / elapsed << '\n'
+            << "allocations:  " << allocations << " in steps, "
+            << steadyAllocations << " in " << allocatingSteadySteps << " of last "
+            << options.frames - options.frames / 2 << " steps\n"
+            << "frame arena:  " << engine.frameArena().capacity() << " bytes, "
+            << engine.frameArena().blockAllocations() << " block allocations\n";
+  try
+  {
+    if( !options.traceFileName.empty() )
+      writeTrace( options.traceFileName, trace );
+    if( !options.referenceFileName.empty() )
+      printDrift( trace, reference );
+  }
+  catch( const std::invalid_argument &e )
+  {
+    std::cerr << e.what();
+    return 1;
+  }
+  std::cout << '\n';
+
+#ifdef PHYSICS_PROFILING
+  std::cout << std::left << std::setw( 20 ) << "phase" << std::right
+            << std::setw( 12 ) << "total [ms]" << std::setw( 16 ) << "per step [us]" << '\n';
+  printPhase( "accumulate forces", total.accumulateForces, options.frames );
+  printPhase( "apply forces", total.applyForces, options.frames );
+  printPhase( "collision search 1", total.search[ 0 ].time, options.frames );
+  printPhase( "impulses", total.impulses, options.frames );
+  printPhase( "collision search 2", total.search[ 1 ].time, options.frames );
+  printPhase( "resolution", total.resolution, options.frames );
+
+  size_t pairTests = total.search[ 0 ].pairTests + total.search[ 1 ].pairTests;
+  size_t manifolds = total.search[ 0 ].manifolds + total.search[ 1 ].manifolds;
+  std::cout << "\npair tests:   " << pairTests
+            << " ( " << (double)pairTests / (double)options.frames << " per step )\n"
+            << "manifolds:    " << manifolds
+            << " ( " << (double)manifolds / (double)options.frames << " per step, "
+            << mostManifolds << " max )\n"
+            << "contacts:     " << total.contacts << '\n';
+
+  const auto &histogram = engine.stepHistogram;
+  std::cout << "\nlast " << histogram.size() << " steps: median "
+            << histogram.percentile( 0.5 ) * 1e6 << " us, 99th percentile "
+            << histogram.percentile( 0.99 ) * 1e6 << " us\n";
+  for( size_t bucket = 0; bucket < CStepHistogram::bucketCount; ++bucket )
+    if( histogram.buckets()[ bucket ] )
+      std::cout << "  < " << std::setw( 10 ) << CStepHistogram::bucketUpperBound( bucket ) * 1e6
+                << " us: " << histogram.buckets()[ bucket ] << '\n';
+#else
+  std::cout << "phase timings need build with PHYSICS_PROFILING ( make benchmark )\n";
+#endif
+
+  for( auto object: objects )
+    delete object;
+  for( auto text: texts )
+    delete text;
+
+  if( options.assertNoAllocations && allocations )
+  {
+    std::cerr << "steps allocated from heap after warm up\n";
+    return 1;
+  }
+  return 0;
+}
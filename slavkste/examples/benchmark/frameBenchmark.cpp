@@ -0,0 +1,142 @@
+#include "../../src/game.hpp"
+#include "../../src/softwareRenderer.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+/**
+ * Frame time benchmark without display.
+ * Runs game on level, one physics step per frame, and renders every frame by CGame::redraw
+ * to memory with software renderer, then prints render times.
+ * With -o last frame is written to PPM image, with -c it is compared to golden PPM image.
+ *
+ * usage: frameBenchmark [-f frames] [-w width] [-h height] [-o image.ppm] [-c golden.ppm] level.json
+ */
+
+struct TFrameBenchmarkOptions
+{
+  std::string levelFileName = "assets/level_1.json";
+  size_t frames = 500;
+  int width = 800;
+  int height = 640;
+  std::string imageFileName;
+  std::string goldenFileName;
+};
+
+static void printUsage( const char *name )
+{
+  std::cerr << "usage: " << name << " [-f frames] [-w width] [-h height] [-o image.ppm] [-c golden.ppm] level.json\n";
+}
+
+static bool parseOptions( int argc, char *argv[], TFrameBenchmarkOptions &options )
+{
+  for( int idx = 1; idx < argc; ++idx )
+  {
+    bool hasValue = idx + 1 < argc;
+    if( !strcmp( argv[ idx ], "-f" ) && hasValue )
+      options.frames = std::stoul( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-w" ) && hasValue )
+      options.width = std::stoi( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-h" ) && hasValue )
+      options.height = std::stoi( argv[ ++idx ] );
+    else if( !strcmp( argv[ idx ], "-o" ) && hasValue )
+      options.imageFileName = argv[ ++idx ];
+    else if( !strcmp( argv[ idx ], "-c" ) && hasValue )
+      options.goldenFileName = argv[ ++idx ];
+    else if( argv[ idx ][ 0 ] == '-' )
+      return false;
+    else
+      options.levelFileName = argv[ idx ];
+  }
+  return options.width > 0 && options.height > 0;
+}
+
+/**
+ * @return Number of pixels of frame differing from golden image, or -1 if sizes differ.
+ */
+static long compareGolden( const CSoftwareRenderer &frame, const std::string &goldenFileName )
+{
+  std::ifstream file( goldenFileName, std::ios::binary );
+  if( !file )
+    throw std::invalid_argument( "Can not open image " + goldenFileName + ".\n" );
+  std::string golden( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+  std::ostringstream stream;
+  frame.writePPM( stream );
+  std::string rendered = stream.str();
+  if( golden.size() != rendered.size() )
+    return -1;
+
+  size_t header = rendered.size() - frame.pixels().size();
+  if( golden.compare( 0, header, rendered, 0, header ) != 0 )
+    return -1;
+  long differing = 0;
+  for( size_t idx = header; idx < rendered.size(); idx += 3 )
+    differing += golden.compare( idx, 3, rendered, idx, 3 ) != 0;
+  return differing;
+}
+
+int main( int argc, char *argv[] )
+{
+  TFrameBenchmarkOptions options;
+  if( !parseOptions( argc, argv, options ) || !options.frames )
+  {
+    printUsage( argv[ 0 ] );
+    return 1;
+  }
+
+  try
+  {
+    auto renderer = std::make_unique<CSoftwareRenderer>( options.width, options.height );
+    const CSoftwareRenderer &frame = *renderer;
+    CGame game( options.levelFileName, std::move( renderer ), options.width, options.height );
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve( options.frames );
+    for( size_t idx = 0; idx < options.frames; ++idx )
+    {
+      game.step();
+      auto start = std::chrono::steady_clock::now();
+      game.redraw();
+      frameTimes.push_back( std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+    }
+
+    double total = 0;
+    for( double time: frameTimes )
+      total += time;
+    std::sort( frameTimes.begin(), frameTimes.end() );
+
+    std::cout << std::fixed << std::setprecision( 3 )
+              << "level:        " << options.levelFileName << '\n'
+              << "frame size:   " << options.width << " x " << options.height << '\n'
+              << "frames:       " << options.frames << '\n'
+              << "render [s]:   " << total << '\n'
+              << "frames/s:     " << (double)options.frames / total << '\n'
+              << "frame [ms]:   " << total * 1e3 / (double)options.frames << " mean, "
+              << frameTimes[ frameTimes.size() / 2 ] * 1e3 << " median, "
+              << frameTimes[ frameTimes.size() * 99 / 100 ] * 1e3 << " 99th percentile, "
+              << frameTimes.back() * 1e3 << " max\n";
+
+    if( !options.imageFileName.empty() )
+      frame.writePPM( options.imageFileName );
+    if( !options.goldenFileName.empty() )
+    {
+      long differing = compareGolden( frame, options.goldenFileName );
+      if( differing < 0 )
+        std::cout << "image:        size differs from golden image\n";
+      else
+        std::cout << "image:        " << differing << " pixels differ from golden image\n";
+      return differing == 0 ? 0 : 2;
+    }
+    return 0;
+  }
+  catch( const std::invalid_argument &e )
+  {
+    std::cerr << e.what();
+    return 1;
+  }
+}
@@ -0,0 +1,122 @@
+#include "../../src/linearAlgebra.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <functional>
+
+/**
+ * Micro-benchmark of vector kernels used by physics.
+ * Compiled once with specialisations and once with -DLINEAR_ALGEBRA_GENERIC,
+ * checksums of both builds must be same.
+ *
+ * usage: vectorBenchmark [repetitions]
+ */
+
+static const size_t vectorCount = 4096;
+
+struct TVectorData
+{
+  std::vector<TVector<2>> first, second, third;
+  std::vector<TVector<4>> wideFirst, wideSecond;
+  std::vector<double> scales;
+};
+
+static TVectorData generate()
+{
+  std::mt19937 generator( 7 );
+  std::uniform_real_distribution<double> value( -100, 100 );
+  TVectorData data;
+  for( size_t idx = 0; idx < vectorCount; ++idx )
+  {
+    data.first.push_back( { value( generator ), value( generator ) } );
+    data.second.push_back( { value( generator ), value( generator ) } );
+    data.third.push_back( { value( generator ), value( generator ) } );
+    data.wideFirst.push_back( { value( generator ), value( generator ), value( generator ), value( generator ) } );
+    data.wideSecond.push_back( { value( generator ), value( generator ), value( generator ), value( generator ) } );
+    data.scales.push_back( value( generator ) );
+  }
+  // some invalid vectors for validity test
+  for( size_t idx = 0; idx < vectorCount; idx += 17 )
+    data.first[ idx ][ idx % 2 ] = NAN;
+  return data;
+}
+
+static void run( const std::string &name, size_t repetitions, const std::function<double()> &kernel )
+{
+  double checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for( size_t repetition = 0; repetition < repetitions; ++repetition )
+    checksum += kernel();
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw( 14 ) << std::left << name
+            << std::setw( 10 ) << std::right << std::fixed << std::setprecision( 3 )
+            << elapsed.count() / (double)( repetitions * vectorCount ) << " ns/op   checksum "
+            << std::setprecision( 6 ) << checksum << "\n";
+}
+
+int main( int argc, char *argv[] )
+{
+  size_t repetitions = argc > 1 ? std::stoul( argv[ 1 ] ) : 2000;
+  TVectorData data = generate();
+  auto rotation = TMatrix<2, 2>::rotationMatrix2D( 0.3 );
+
+#ifdef LINEAR_ALGEBRA_GENERIC
+  std::cout << "generic templates\n";
+#else
+  std::cout << "specialised kernels\n";
+#endif
+
+  run( "accumulate", repetitions, [ & ]()
+  {
+    TVector<2> sum;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+      sum += data.second[ idx ] * data.scales[ idx ] - data.third[ idx ];
+    return sum[ 0 ] + sum[ 1 ];
+  } );
+
+  run( "dot", repetitions, [ & ]()
+  {
+    double sum = 0;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+      sum += data.second[ idx ].dot( data.third[ idx ] ) + data.second[ idx ].squareNorm();
+    return sum;
+  } );
+
+  run( "valid", repetitions, [ & ]()
+  {
+    double count = 0;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+      count += data.first[ idx ] ? 1 : 0;
+    return count;
+  } );
+
+  run( "rotate", repetitions, [ & ]()
+  {
+    TVector<2> sum;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+      sum += rotation * data.second[ idx ];
+    return sum[ 0 ] + sum[ 1 ];
+  } );
+
+  run( "corners", repetitions, [ & ]()
+  {
+    TVector<2> sum;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+    {
+      TMatrix<2, 4> corners = parallelogram( data.third[ ( idx + 1 ) % vectorCount ],
+                                             data.second[ idx ], data.third[ idx ] );
+      sum += corners[ 0 ] - corners[ 3 ];
+    }
+    return sum[ 0 ] + sum[ 1 ];
+  } );
+
+  run( "wide", repetitions, [ & ]()
+  {
+    TVector<4> sum;
+    for( size_t idx = 0; idx < vectorCount; ++idx )
+      sum += data.wideFirst[ idx ] * data.scales[ idx ] - data.wideSecond[ idx ];
+    return sum.dot( { 1, 1, 1, 1 } );
+  } );
+}
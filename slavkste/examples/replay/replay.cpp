@@ -0,0 +1,56 @@
+#include "../../src/game.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * Headless session replayer.
+ * Re-runs game recorded with "slavkste --record session.log" without display
+ * and checks that final state is bit-identical with recording.
+ *
+ * usage: replay session.log
+ */
+
+int main( int argc, char *argv[] )
+{
+  if( argc != 2 )
+  {
+    std::cerr << "usage: " << argv[ 0 ] << " session.log\n";
+    return 1;
+  }
+
+  try
+  {
+    CSessionLog log( argv[ 1 ] );
+    CGame game( log.levelFileName );
+
+    auto start = std::chrono::steady_clock::now();
+    game.replay( log );
+    double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << std::fixed << std::setprecision( 3 )
+              << "level:        " << log.levelFileName << '\n'
+              << "events:       " << log.events.size() << '\n'
+              << "steps:        " << game.steps() << '\n'
+              << "elapsed [s]:  " << elapsed << '\n'
+              << "steps/s:      " << (double)game.steps() / elapsed << '\n';
+
+    const auto &strokes = game.strokeStatistics();
+    std::cout << "strokes:      " << strokes.strokes << ", " << strokes.vertices << " vertices drawn, "
+              << strokes.removedVertices << " removed by simplification\n";
+
+    if( log.events.empty() || log.events.back().type != ESessionEvent::end )
+    {
+      std::cout << "state:        not recorded, session did not end properly\n";
+      return 0;
+    }
+    bool matches = log.events.back().stateHash == game.stateHash();
+    std::cout << "state:        " << ( matches ? "matches recording" : "differs from recording" ) << '\n';
+    return matches ? 0 : 2;
+  }
+  catch( const std::invalid_argument &e )
+  {
+    std::cerr << e.what();
+    return 1;
+  }
+}
@@ -1,5 +1,15 @@
 #include "../../src/jsonParser.hpp"
 #include "../../src/linearAlgebra.hpp"
+#include "../../src/broadPhase.hpp"
+#include "../../src/physicsEngine.hpp"
+#include "../../src/circle.hpp"
+#include "../../src/rectangle.hpp"
+#include "../../src/complexObject.hpp"
+#include "../../src/rayCaster.hpp"
+#include "../../src/narrowPhase.hpp"
+#include "../../src/shapeDispatch.hpp"
+#include "../../src/softwareRenderer.hpp"
+#include "../../src/window.hpp"
 #include <cassert>
 
 void jsonParserTest()
@@ -811,10 +821,439 @@ void linearAlgebraTest()
   TMatrix<2,2> m2{ { 4, 1 }, { 11, 3 } };
   assert( m2.invert() );
   assert( compareMatrices( m2, TMatrix<2,2>{ { 3, -1 }, { -11, 4 } } ) );
+
+  assert( compareMatrices( parallelogram( vec2d{ 1, 1 }, vec2d{ 2, 1 }, vec2d{ 2, -1 } ),
+                           TMatrix<2,4>{ { 3, 2 }, { 3, 0 }, { -1, 0 }, { -1, 2 } } ) );
+  assert( ( m1 * vec2d{ 1, 2 } )[ 0 ] == 2 );
+  assert( ( !vec2d{ 1, NAN } && vec2d{ 1, HUGE_VAL } ) );
+  assert( ( !TVector<4>{ 1, 2, 3, NAN } ) );
+  assert( ( ( TVector<4>{ 1, 2, 3, 4 } * 2. ).dot( { 1, 1, 1, 1 } ) == 20 ) );
+}
+
+void broadPhaseTest()
+{
+  std::vector<CPhysicsObject *> objects;
+  for( size_t idx = 0; idx < 60; ++idx )
+  {
+    TVector<2> position{ (double)( idx * 37 % 500 ), (double)( idx * 53 % 400 ) };
+    if( idx % 3 )
+      objects.push_back( new CCircle( position, 5. + (double)( idx % 7 ) * 4, 1 ) );
+    else
+      objects.push_back( new CRectangle( position, { 80, 10 }, (double)idx, 1 ) );
+  }
+  objects[ 5 ]->m_boundingRadius = HUGE_VAL;
+
+  CBruteForceBroadPhase bruteForce;
+  CSweepAndPruneBroadPhase sweepAndPrune;
+  CUniformGridBroadPhase grid( 32 );
+  for( size_t frame = 0; frame < 3; ++frame )
+  {
+    const auto &expected = bruteForce.findPairs( objects );
+    assert( !expected.empty() );
+    assert( sweepAndPrune.findPairs( objects ) == expected );
+    assert( grid.findPairs( objects ) == expected );
+    for( auto object: objects )
+      object->m_position[ 0 ] += (double)( frame * 11 ) - object->m_position[ 1 ] / 20;
+  }
+
+  CPhysicsEngine engine;
+  try
+  {
+    engine.setBroadPhase( nullptr );
+    assert( "Empty broad-phase" == nullptr );
+  }
+  catch( const std::invalid_argument & )
+  {}
+  engine.step( objects, 0.04 );
+
+  for( auto object: objects )
+    delete object;
+}
+
+void sleepingTest()
+{
+  CPhysicsEngine engine;
+  engine.addField( CForceField::gravitationalField() );
+  engine.setSleeping( true );
+
+  std::vector<CPhysicsObject *> objects{ new CRectangle( { 200, 10 }, { 400, 20 }, 0, HUGE_VAL ),
+                                         new CCircle( { 200, 40 }, 10, 1 ) };
+  for( size_t frame = 0; frame < 200; ++frame )
+    engine.step( objects, 0.04 );
+  assert( objects[ 1 ]->m_sleeping );
+
+  TVector<2> restPosition = objects[ 1 ]->m_position;
+  engine.step( objects, 0.04 );
+  assert( ( objects[ 1 ]->m_position - restPosition ).squareNorm() == 0 );
+
+  objects.push_back( new CCircle( { 200, 48 }, 10, 1 ) );
+  engine.step( objects, 0.04 );
+  assert( !objects[ 1 ]->m_sleeping );
+
+  for( auto object: objects )
+    delete object;
+}
+
+void solverTest()
+{
+  CPhysicsEngine engine;
+  engine.addField( CForceField::gravitationalField() );
+  TSolverSettings settings;
+  settings.velocityIterations = 8;
+  settings.warmStarting = true;
+  engine.setSolver( settings );
+
+  std::vector<CPhysicsObject *> objects{ new CRectangle( { 200, 10 }, { 400, 20 }, 0, HUGE_VAL ),
+                                         new CRectangle( { 100, 60 }, { 20, 100 }, 0, HUGE_VAL ),
+                                         new CRectangle( { 300, 60 }, { 20, 100 }, 0, HUGE_VAL ) };
+  for( size_t row = 0; row < 4; ++row )
+    for( size_t idx = 0; idx < 9 - row; ++idx )
+      objects.push_back( new CCircle( { 120 + (double)( idx * 20 + row * 10 ), 30 + (double)row * 17.5 },
+                                      10, 1 ) );
+
+  for( size_t frame = 0; frame < 300; ++frame )
+    engine.step( objects, 0.04 );
+  for( auto object: objects )
+    assert( object->m_attributes.velocity.norm() < 0.1 );
+
+  for( auto object: objects )
+    delete object;
+}
+
+void contactCacheTest()
+{
+  CPhysicsEngine engine;
+  size_t begins = 0, ends = 0, endContacts = 0;
+  engine.setContactBeginCallback( [ &begins ]( const TManifold & ){ ++begins; } );
+  engine.setContactEndCallback( [ &ends, &endContacts ]( const TManifold &manifold )
+  {
+    ++ends;
+    endContacts = manifold.contacts.size();
+  } );
+
+  std::vector<CPhysicsObject *> objects{ new CCircle( { 0, 0 }, 10, 1 ),
+                                         new CCircle( { 15, 0 }, 10, 1 ) };
+  engine.step( objects, 0.04 );
+  engine.step( objects, 0.04 );
+  assert( begins == 1 && ends == 0 );
+
+  objects[ 1 ]->m_position = { 100, 0 };
+  engine.step( objects, 0.04 );
+  assert( begins == 1 && ends == 1 && endContacts == 1 );
+
+  for( auto object: objects )
+    delete object;
+}
+
+void continuousTest()
+{
+  for( bool continuous: { false, true } )
+  {
+    CPhysicsEngine engine;
+    std::vector<CPhysicsObject *> objects{ new CRectangle( { 100, 0 }, { 10, 200 }, 0, HUGE_VAL ),
+                                           new CCircle( { 0, 0 }, 5, 1 ) };
+    objects[ 1 ]->m_continuous = continuous;
+    objects[ 1 ]->m_attributes.velocity = { 2000, 0 };
+    for( size_t frame = 0; frame < 5; ++frame )
+      engine.step( objects, 0.04 );
+    assert( ( objects[ 1 ]->m_position[ 0 ] < 100 ) == continuous );
+
+    for( auto object: objects )
+      delete object;
+  }
+
+  // only nearer of two walls is hit, circles around path are not swept against
+  {
+    CPhysicsEngine engine;
+    std::vector<CPhysicsObject *> objects{ new CRectangle( { 300, 0 }, { 10, 200 }, 0, HUGE_VAL ),
+                                           new CCircle( { 0, 0 }, 5, 1 ),
+                                           new CRectangle( { 150, 0 }, { 10, 200 }, 0, HUGE_VAL ) };
+    for( int idx = 0; idx < 10; ++idx )
+      objects.push_back( new CCircle( { idx * 30., 40 }, 5, 1 ) );
+    objects[ 1 ]->m_continuous = true;
+    objects[ 1 ]->m_attributes.velocity = { 8000, 0 };
+    engine.step( objects, 0.04 );
+    assert( objects[ 1 ]->m_position[ 0 ] < 150 );
+
+    for( auto object: objects )
+      delete object;
+  }
+
+  TVector<2> size{ 5, 10 };
+  assert( collision::sweepCircleRect( { 0, 0 }, { 100, 0 }, 5, { 50, 0 }, size, 0 ) == TScalar( 0.4 ) );
+  assert( collision::sweepCircleRect( { 0, 0 }, { 100, 0 }, 5, { 50, 16 }, size, 0 ) == HUGE_VAL );
+  assert( collision::sweepCircleRect( { 50, 0 }, { 100, 0 }, 5, { 50, 0 }, size, 0 ) == HUGE_VAL );
+  double corner = collision::sweepCircleRect( { 0, 14 }, { 100, 14 }, 5, { 50, 0 }, size, 0 );
+  assert( corner > 0.4 && corner < 0.5 );
+}
+
+void simplifyTest()
+{
+  CComplexObject stroke( 8 );
+  for( int idx = 0; idx <= 10; ++idx )
+    stroke.addVertex( { idx * 20., idx % 2 ? 1. : 0. } );
+  for( int idx = 1; idx <= 10; ++idx )
+    stroke.addVertex( { 200, idx * 20. } );
+  assert( stroke.simplify( 2 ) == 18 );
+  assert( stroke.vertexCount() == 3 );
+  assert( stroke.rayTrace( { 100, 50 }, { 0, -1 } ) == 42 );
+}
+
+void rayCasterTest()
+{
+  std::vector<CPhysicsObject *> objects;
+  for( int idx = 0; idx < 100; ++idx )
+  {
+    TVector<2> position{ ( idx * 37 ) % 1000 * 1., ( idx * 61 ) % 800 * 1. };
+    if( idx % 2 )
+      objects.push_back( new CCircle( position, 5 + idx % 7, 1 ) );
+    else
+      objects.push_back( new CRectangle( position, { 10. + idx % 5, 20 }, idx * 0.1, 1 ) );
+  }
+  objects.push_back( new CRectangle( { 500, -10 }, { 2000, 20 }, 0, HUGE_VAL ) );
+  CRayCaster caster( 32 );
+  caster.build( objects );
+
+  for( int idx = 0; idx < 200; ++idx )
+  {
+    TRay ray{ { ( idx * 53 ) % 1000 * 1., ( idx * 29 ) % 800 * 1. },
+              TVector<2>::canonical( 0 ).rotated( idx * 0.7 ) };
+    TRayHit expected;
+    for( auto object: objects )
+    {
+      TScalar distance = object->rayTrace( ray.origin, ray.direction );
+      if( distance < expected.distance )
+        expected = { object, distance };
+    }
+    TRayHit hit = caster.nearest( ray, HUGE_VAL );
+    assert( hit.object == expected.object && hit.distance == expected.distance );
+    if( expected.distance <= 100 )
+      assert( caster.nearest( ray, 100 ).object == expected.object );
+  }
+
+  for( auto object: objects )
+    delete object;
+}
+
+void narrowPhaseTest()
+{
+  auto sameContact = []( const TContactPoint &first, const TContactPoint &second )
+  {
+    if( !first.contactPoint || !second.contactPoint )
+      return !first.contactPoint && !second.contactPoint;
+    return first.overlapVector[ 0 ] == second.overlapVector[ 0 ] &&
+           first.overlapVector[ 1 ] == second.overlapVector[ 1 ] &&
+           first.contactPoint[ 0 ] == second.contactPoint[ 0 ] &&
+           first.contactPoint[ 1 ] == second.contactPoint[ 1 ] &&
+           first.feature == second.feature;
+  };
+
+  TCirclePairs circles;
+  TRectCirclePairs rectCircles;
+  for( int idx = 0; idx < 37; ++idx )
+  {
+    TVector<2> first{ idx * 3., idx % 5 * 2. }, second{ idx * 3. + idx % 7, 4. };
+    circles.push( first, 5, second, 1 + idx % 4 );
+    rectCircles.push( collision::rectCorners( first, { 4, 2 }, idx * 0.3 ), second, 1 + idx % 4 );
+  }
+  std::vector<TContactPoint> contacts( circles.size() );
+  collision::circleCircle( circles, contacts.data() );
+  for( size_t idx = 0; idx < circles.size(); ++idx )
+    assert( sameContact( contacts[ idx ],
+                         collision::circleCircle( { circles.firstX[ idx ], circles.firstY[ idx ] },
+                                                  circles.firstRadius[ idx ],
+                                                  { circles.secondX[ idx ], circles.secondY[ idx ] },
+                                                  circles.secondRadius[ idx ] ) ) );
+  collision::rectCircle( rectCircles, contacts.data() );
+  for( int idx = 0; idx < 37; ++idx )
+    assert( sameContact( contacts[ idx ],
+                         collision::rectCircle( { idx * 3., idx % 5 * 2. }, { 4, 2 }, idx * 0.3,
+                                                { idx * 3. + idx % 7, 4. }, 1 + idx % 4 ) ) );
+}
+
+void shapeDispatchTest()
+{
+  auto stroke = new CComplexObject( 5 );
+  stroke->addVertex( { 0, 0 } );
+  stroke->addVertex( { 40, 10 } );
+  stroke->addVertex( { 80, 0 } );
+  stroke->spawn( 1 );
+  std::vector<CPhysicsObject *> objects{ new CCircle( { 30, 12 }, 10, 1 ),
+                                         new CCircle( { 45, 15 }, 8, 1 ),
+                                         new CRectangle( { 40, 20 }, { 30, 10 }, 0.3, 1 ),
+                                         new CRectangle( { 50, 5 }, { 20, 20 }, 1, 1 ),
+                                         stroke };
+  for( auto first: objects )
+    for( auto second: objects )
+    {
+      if( first == second )
+        continue;
+      TManifold expected = first->getManifold( second );
+      TManifold manifold = collision::getManifold( first, second );
+      assert( manifold.first == expected.first && manifold.second == expected.second );
+      assert( manifold.contacts.size() == expected.contacts.size() );
+      for( size_t idx = 0; idx < expected.contacts.size(); ++idx )
+        assert( manifold.contacts[ idx ].feature == expected.contacts[ idx ].feature &&
+                manifold.contacts[ idx ].overlapVector[ 0 ] == expected.contacts[ idx ].overlapVector[ 0 ] );
+    }
+
+  for( auto object: objects )
+    delete object;
+}
+
+void frameArenaTest()
+{
+  CFrameArena arena( 64 );
+  for( size_t frame = 0; frame < 3; ++frame )
+  {
+    arena.reset();
+    CFrameArena::CScope scope( arena );
+    TFrameVector<TContactPoint> contacts;
+    for( size_t idx = 0; idx < 100; ++idx )
+      contacts.push_back( { { (double)idx, 0 }, { 0, (double)idx }, idx } );
+    assert( contacts[ 99 ].feature == 99 && contacts.get_allocator().arena() == &arena );
+    assert( (uintptr_t)contacts.data() % alignof( TContactPoint ) == 0 );
+  }
+  // blocks of first frame are merged, later frames fit in single block
+  size_t blocks = arena.blockAllocations();
+  arena.reset();
+  assert( arena.used() == 0 && arena.blockAllocations() == blocks );
+
+  TFrameVector<size_t> heap;
+  {
+    CFrameArena::CScope scope( arena );
+    TFrameVector<size_t> temporary( 10, 1 );
+    heap = temporary;
+  }
+  assert( !heap.get_allocator().arena() && !CFrameArena::active() );
+
+  std::vector<CPhysicsObject *> objects{ new CCircle( { 0, 0 }, 10, 1 ),
+                                         new CCircle( { 15, 0 }, 10, 1 ) };
+  CPhysicsEngine engine;
+  engine.step( objects, 0.04 );
+  blocks = engine.frameArena().blockAllocations();
+  for( size_t frame = 0; frame < 10; ++frame )
+    assert( engine.step( objects, 0.04 ).size() == 2 );
+  assert( engine.frameArena().blockAllocations() == blocks );
+
+  for( auto object: objects )
+    delete object;
+
+  // worker of outer pool is caller of inner pool, it must not take arena of inner worker
+  CThreadPool outer( 4 ), inner( 2 );
+  std::atomic<size_t> misplaced{ 0 };
+  outer.parallelFor( 64, [ & ]( size_t )
+  {
+    if( outer.threadIndex() >= outer.threadCount() || inner.threadIndex() != 0 )
+      ++misplaced;
+  } );
+  assert( misplaced == 0 && outer.threadIndex() == 0 );
+}
+
+void forceFieldTest()
+{
+  // built-in gravity matches gravity given by function
+  CPhysicsEngine builtIn, functor;
+  builtIn.addField( CForceField::gravitationalField() );
+  functor.addField( CForceField( []( CPhysicsObject &object )
+  {
+    object.m_attributes.forceAccumulator += 50 * object.m_attributes.mass * TVector<2>{ 0, -1 };
+  } ) );
+  std::vector<CPhysicsObject *> first{ new CCircle( { 0, 100 }, 10, 1 ), new CRectangle( { 50, 100 }, { 20, 10 }, 0.3, 2 ) };
+  std::vector<CPhysicsObject *> second{ new CCircle( { 0, 100 }, 10, 1 ), new CRectangle( { 50, 100 }, { 20, 10 }, 0.3, 2 ) };
+  for( size_t frame = 0; frame < 50; ++frame )
+  {
+    builtIn.step( first, 0.04 );
+    functor.step( second, 0.04 );
+  }
+  for( size_t idx = 0; idx < first.size(); ++idx )
+    assert( first[ idx ]->m_position.squareDistance( second[ idx ]->m_position ) == 0 );
+
+  CPhysicsEngine engine;
+  engine.addField( CForceField::radialField( { 0, 0 }, 10, 150 ) );
+  engine.addField( CForceField::windField( { 900, -50 }, { 1100, 50 }, { 0, 20 }, 1 ) );
+  engine.addField( CForceField::dragField( 0.5 ) );
+  std::vector<CPhysicsObject *> objects{ new CCircle( { 100, 0 }, 5, 1 ),
+                                         new CCircle( { 200, 0 }, 5, 1 ),
+                                         new CCircle( { 1000, 0 }, 5, 1 ),
+                                         new CCircle( { 500, 0 }, 5, 1 ) };
+  objects[ 3 ]->m_attributes.velocity = { 10, 0 };
+  engine.step( objects, 0.04 );
+  // attracted in radius only
+  assert( objects[ 0 ]->m_attributes.velocity[ 0 ] < 0 && objects[ 0 ]->m_attributes.velocity[ 1 ] == 0 );
+  assert( objects[ 1 ]->m_attributes.velocity.squareNorm() == 0 );
+  // wind in region
+  assert( objects[ 2 ]->m_attributes.velocity[ 1 ] > 0 && objects[ 2 ]->m_attributes.velocity[ 1 ] < 20 );
+  // drag slows down
+  assert( objects[ 3 ]->m_attributes.velocity[ 0 ] > 0 && objects[ 3 ]->m_attributes.velocity[ 0 ] < 10 );
+
+  for( auto object: first )
+    delete object;
+  for( auto object: second )
+    delete object;
+  for( auto object: objects )
+    delete object;
+}
+
+void softwareRendererTest()
+{
+  auto pixel = []( const CSoftwareRenderer &frame, size_t column, size_t row )
+  {
+    size_t idx = 3 * ( ( frame.height() - 1 - row ) * frame.width() + column );
+    return std::vector<uint8_t>( frame.pixels().begin() + (long)idx, frame.pixels().begin() + (long)idx + 3 );
+  };
+  const std::vector<uint8_t> black{ 0, 0, 0 }, white{ 255, 255, 255 }, player{ 230, 26, 230 };
+
+  // scene 0 - 10 shown 1:2 in viewport moved by 1 pixel
+  CSoftwareRenderer frame( 22, 22 );
+  frame.setView( { 0, 0 }, { 10, 10 }, { 1, 1 }, 2 );
+  frame.drawTriangles( { 2, 2, 6, 2, 6, 6, 2, 2, 6, 6, 2, 6 }, TPen::of( ETag::PLAYER ) );
+  assert( pixel( frame, 5, 5 ) == player && pixel( frame, 12, 12 ) == player );
+  assert( pixel( frame, 4, 5 ) == black && pixel( frame, 13, 12 ) == black );
+
+  // first drawing of same depth stays, larger depth covers
+  frame.drawTriangles( { 0, 0, 10, 0, 0, 10 }, TPen::of( ETag::NONE ) );
+  frame.drawTriangles( { 0, 0, 10, 0, 0, 10 }, TPen::of( ETag::NON_SOLID ) );
+  assert( pixel( frame, 5, 5 ) == player && pixel( frame, 2, 2 ) == white );
+  frame.drawTriangles( { 0, 0, 10, 0, 0, 10 }, TPen::of( ETag::TRANSPARENT | ETag::TARGET ) );
+  assert( pixel( frame, 5, 5 )[ 1 ] == 230 );
+  // drawing is clipped to viewport
+  frame.drawTriangles( { -5, -5, 15, -5, -5, 15 }, TPen::of( ETag::HEALTH ) );
+  assert( pixel( frame, 0, 0 ) == black && pixel( frame, 21, 0 ) == black );
+
+  frame.clear();
+  assert( std::all_of( frame.pixels().begin(), frame.pixels().end(), []( uint8_t value ){ return value == 0; } ) );
+
+  // window draws batched circle to renderer
+  auto renderer = std::make_unique<CSoftwareRenderer>( 100, 100 );
+  const CSoftwareRenderer &windowFrame = *renderer;
+  CWindow window( std::move( renderer ), 100, 100 );
+  window.resizeView( 0, 50, 0, 50 );
+  assert( window.drawing() && window.headless() );
+  window.clear();
+  window.drawCircle( { 25, 25 }, 10, 0 );
+  assert( pixel( windowFrame, 50, 60 ) == black );
+  window.flush();
+  window.present();
+  assert( pixel( windowFrame, 50, 60 ) == white && pixel( windowFrame, 50, 75 ) == black );
+  // mark is drawn over circle
+  assert( pixel( windowFrame, 60, 50 ) == black && pixel( windowFrame, 50, 40 ) == white );
 }
 
 int main()
 {
   jsonParserTest();
   linearAlgebraTest();
+  broadPhaseTest();
+  sleepingTest();
+  solverTest();
+  contactCacheTest();
+  continuousTest();
+  simplifyTest();
+  rayCasterTest();
+  narrowPhaseTest();
+  frameArenaTest();
+  shapeDispatchTest();
+  forceFieldTest();
+  softwareRendererTest();
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "bodyStore.hpp"
+
+
+using namespace std;
+
+void TBodyStore::resize( size_t count )
+{
+  if( count == size() )
+    return;
+  for( auto array: { &positionX, &positionY, &velocityX, &velocityY,
+                     &angularVelocity, &rotation, &mass, &invMass, &invAngularMass,
+                     &forceX, &forceY, &moment } )
+    array->resize( count );
+  sleeping.resize( count );
+}
+
+void TBodyStore::gather( size_t index, const CPhysicsObject &object )
+{
+  const auto &attributes = object.m_attributes;
+  positionX[ index ] = object.m_position[ 0 ];
+  positionY[ index ] = object.m_position[ 1 ];
+  velocityX[ index ] = attributes.velocity[ 0 ];
+  velocityY[ index ] = attributes.velocity[ 1 ];
+  angularVelocity[ index ] = attributes.angularVelocity;
+  mass[ index ] = attributes.mass;
+  invMass[ index ] = attributes.invMass;
+  invAngularMass[ index ] = attributes.invAngularMass;
+  sleeping[ index ] = object.m_sleeping;
+  rotation[ index ] = 0;
+  forceX[ index ] = 0;
+  forceY[ index ] = 0;
+  moment[ index ] = 0;
+}
+
+void TBodyStore::scatter( vector<CPhysicsObject *> &objects ) const
+{
+  for( size_t idx = 0; idx < size(); ++idx )
+  {
+    if( invMass[ idx ] == 0 || sleeping[ idx ] )
+      continue;
+    auto &object = *objects[ idx ];
+    auto &attributes = object.m_attributes;
+    object.m_position = { positionX[ idx ], positionY[ idx ] };
+    attributes.velocity = { velocityX[ idx ], velocityY[ idx ] };
+    attributes.angularVelocity = angularVelocity[ idx ];
+    if( rotation[ idx ] != 0 )
+      object.rotate( rotation[ idx ] );
+  }
+}
+
+void TBodyStore::addForce( size_t index, const TVector<2> &force, TScalar addedMoment )
+{
+  forceX[ index ] += force[ 0 ];
+  forceY[ index ] += force[ 1 ];
+  moment[ index ] += addedMoment;
+}
+
+void TBodyStore::integrate( TScalar dt )
+{
+  size_t count = size();
+  for( size_t idx = 0; idx < count; ++idx )
+  {
+    if( invMass[ idx ] == 0 || sleeping[ idx ] )
+      continue;
+    velocityX[ idx ] += invMass[ idx ] * forceX[ idx ] * dt;
+    velocityY[ idx ] += invMass[ idx ] * forceY[ idx ] * dt;
+    angularVelocity[ idx ] += invAngularMass[ idx ] * moment[ idx ] * dt;
+
+    positionX[ idx ] += velocityX[ idx ] * dt;
+    positionY[ idx ] += velocityY[ idx ] * dt;
+    rotation[ idx ] = angularVelocity[ idx ] * dt;
+  }
+}
+
+size_t TBodyStore::size() const
+{
+  return positionX.size();
+}
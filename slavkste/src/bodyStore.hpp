@@ -0,0 +1,93 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <vector>
+
+
+/**
+ * Contiguous storage of body state used by force integration.
+ * Each quantity is stored in its own array ( structure of arrays ),
+ * index of body is same as index of object in engine objects vector.
+ * Objects stay owners of their state, as collision response writes it directly.
+ * Arrays are kept between steps and only resized when number of objects changes,
+ * bodies are gathered one by one from loop which accumulates forces of objects
+ * and written back by scatter after integration.
+ */
+struct TBodyStore
+{
+  /**
+   * Sets number of bodies, arrays are reallocated only when it changes.
+   * @param count
+   */
+  void resize( size_t count );
+
+  /**
+   * Copies state of object to store and zeroes accumulators of body.
+   * @param index body index
+   * @param object
+   */
+  void gather( size_t index, const CPhysicsObject &object );
+
+  /**
+   * Writes integrated state back to objects. Static and sleeping bodies are skipped,
+   * objects are rotated only by non-zero rotation.
+   * @param objects same objects as gathered
+   */
+  void scatter( std::vector<CPhysicsObject *> &objects ) const;
+
+  /**
+   * Adds force and moment to accumulators of body.
+   * @param index body index
+   * @param force
+   * @param moment
+   */
+  void addForce( size_t index, const TVector<2> &force, TScalar moment );
+
+  /**
+   * Applies accumulated forces and moments to velocities,
+   * then moves bodies by velocities. Bodies with zero inverse mass and sleeping
+   * bodies are not moved.
+   * @param dt time delta
+   */
+  void integrate( TScalar dt );
+
+  /**
+   * @return Number of bodies in store.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * Centre of mass position.
+   */
+  std::vector<TScalar> positionX, positionY;
+
+  /**
+   * Translational velocity.
+   */
+  std::vector<TScalar> velocityX, velocityY;
+
+  /**
+   * Angular velocity. ( Clockwise )
+   */
+  std::vector<TScalar> angularVelocity;
+
+  /**
+   * Rotation done by last integration.
+   */
+  std::vector<TScalar> rotation;
+
+  /**
+   * Mass, inverse mass and inverse angular mass.
+   */
+  std::vector<TScalar> mass, invMass, invAngularMass;
+
+  /**
+   * Non-zero if body is sleeping.
+   */
+  std::vector<char> sleeping;
+
+  /**
+   * Force and moment accumulators.
+   */
+  std::vector<TScalar> forceX, forceY, moment;
+};
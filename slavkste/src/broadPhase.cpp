@@ -0,0 +1,151 @@
+#include "broadPhase.hpp"
+
+
+using namespace std;
+
+void CBroadPhase::reset()
+{
+  m_pairs.clear();
+}
+
+bool CBroadPhase::boundsOverlap( const CPhysicsObject &first, const CPhysicsObject &second )
+{
+  return !( first.m_boundingRadius + second.m_boundingRadius <
+            ( first.m_position - second.m_position ).norm() );
+}
+
+const vector<TCandidatePair> &CBruteForceBroadPhase::findPairs( const vector<CPhysicsObject *> &objects )
+{
+  m_pairs.clear();
+  for( size_t a = 0; a < objects.size(); ++a )
+    for( size_t b = a + 1; b < objects.size(); ++b )
+      if( boundsOverlap( *objects[ a ], *objects[ b ] ) )
+        m_pairs.emplace_back( a, b );
+  return m_pairs;
+}
+
+const vector<TCandidatePair> &CSweepAndPruneBroadPhase::findPairs( const vector<CPhysicsObject *> &objects )
+{
+  if( objects.size() < m_order.size() )
+    m_order.clear();
+  for( size_t idx = m_order.size(); idx < objects.size(); ++idx )
+    m_order.push_back( idx );
+
+  m_min.resize( objects.size() );
+  m_max.resize( objects.size() );
+  for( size_t idx = 0; idx < objects.size(); ++idx )
+  {
+    m_min[ idx ] = objects[ idx ]->m_position[ 0 ] - objects[ idx ]->m_boundingRadius;
+    m_max[ idx ] = objects[ idx ]->m_position[ 0 ] + objects[ idx ]->m_boundingRadius;
+    if( !isfinite( m_min[ idx ] ) || !isfinite( m_max[ idx ] ) )
+    {
+      m_min[ idx ] = -HUGE_VAL;
+      m_max[ idx ] = HUGE_VAL;
+    }
+  }
+
+  // insertion sort, order from last call is almost sorted
+  for( size_t idx = 1; idx < m_order.size(); ++idx )
+  {
+    size_t current = m_order[ idx ];
+    size_t position = idx;
+    for( ; position > 0 && m_min[ m_order[ position - 1 ] ] > m_min[ current ]; --position )
+      m_order[ position ] = m_order[ position - 1 ];
+    m_order[ position ] = current;
+  }
+
+  m_pairs.clear();
+  for( size_t idx = 0; idx < m_order.size(); ++idx )
+  {
+    size_t first = m_order[ idx ];
+    for( size_t next = idx + 1;
+         next < m_order.size() && m_min[ m_order[ next ] ] <= m_max[ first ];
+         ++next )
+    {
+      size_t second = m_order[ next ];
+      if( !boundsOverlap( *objects[ first ], *objects[ second ] ) )
+        continue;
+      m_pairs.emplace_back( min( first, second ), max( first, second ) );
+    }
+  }
+  sort( m_pairs.begin(), m_pairs.end() );
+  return m_pairs;
+}
+
+void CSweepAndPruneBroadPhase::reset()
+{
+  CBroadPhase::reset();
+  m_order.clear();
+}
+
+CUniformGridBroadPhase::CUniformGridBroadPhase( TScalar cellSize )
+  : m_cellSize( cellSize )
+{}
+
+uint64_t CUniformGridBroadPhase::cellKey( int64_t x, int64_t y )
+{
+  return (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+}
+
+const vector<TCandidatePair> &CUniformGridBroadPhase::findPairs( const vector<CPhysicsObject *> &objects )
+{
+  static const TScalar maxCellsPerObject = 4096;
+
+  m_cells.clear();
+  m_unbounded.clear();
+
+  for( size_t idx = 0; idx < objects.size(); ++idx )
+  {
+    const auto &object = *objects[ idx ];
+    TScalar radius = object.m_boundingRadius;
+    TScalar left = floor( ( object.m_position[ 0 ] - radius ) / m_cellSize );
+    TScalar right = floor( ( object.m_position[ 0 ] + radius ) / m_cellSize );
+    TScalar bottom = floor( ( object.m_position[ 1 ] - radius ) / m_cellSize );
+    TScalar top = floor( ( object.m_position[ 1 ] + radius ) / m_cellSize );
+    if( !isfinite( left + right + bottom + top ) ||
+        ( right - left + 1 ) * ( top - bottom + 1 ) > maxCellsPerObject )
+    {
+      m_unbounded.push_back( idx );
+      continue;
+    }
+    for( auto x = (int64_t)left; x <= (int64_t)right; ++x )
+      for( auto y = (int64_t)bottom; y <= (int64_t)top; ++y )
+        m_cells.emplace_back( cellKey( x, y ), idx );
+  }
+  // entries of same cell become neighbours with ascending object indices
+  sort( m_cells.begin(), m_cells.end() );
+
+  m_pairs.clear();
+  for( size_t begin = 0; begin < m_cells.size(); )
+  {
+    size_t end = begin + 1;
+    while( end < m_cells.size() && m_cells[ end ].first == m_cells[ begin ].first )
+      ++end;
+    for( size_t a = begin; a < end; ++a )
+      for( size_t b = a + 1; b < end; ++b )
+        if( boundsOverlap( *objects[ m_cells[ a ].second ], *objects[ m_cells[ b ].second ] ) )
+          m_pairs.emplace_back( m_cells[ a ].second, m_cells[ b ].second );
+    begin = end;
+  }
+
+  for( size_t unbounded: m_unbounded )
+    for( size_t idx = 0; idx < objects.size(); ++idx )
+    {
+      if( idx == unbounded ||
+          !boundsOverlap( *objects[ unbounded ], *objects[ idx ] ) )
+        continue;
+      m_pairs.emplace_back( min( unbounded, idx ), max( unbounded, idx ) );
+    }
+
+  // objects spanning more cells produce same pair multiple times
+  sort( m_pairs.begin(), m_pairs.end() );
+  m_pairs.erase( unique( m_pairs.begin(), m_pairs.end() ), m_pairs.end() );
+  return m_pairs;
+}
+
+void CUniformGridBroadPhase::reset()
+{
+  CBroadPhase::reset();
+  m_cells.clear();
+  m_unbounded.clear();
+}
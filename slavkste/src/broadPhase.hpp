@@ -0,0 +1,147 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <vector>
+#include <utility>
+
+
+/**
+ * Pair of indices to objects vector. First index is always smaller than second.
+ */
+using TCandidatePair = std::pair<size_t, size_t>;
+
+/**
+ * Base class for broad-phase collision detection.
+ * Broad-phase narrows all object pairs down to pairs with overlapping bounding circles,
+ * only those are then tested for exact collision.
+ */
+class CBroadPhase
+{
+public:
+  virtual ~CBroadPhase() = default;
+
+  /**
+   * Finds all pairs of objects with overlapping bounding circles.
+   * @param objects
+   * @return Candidate pairs sorted by first, then by second index.
+   */
+  virtual const std::vector<TCandidatePair> &findPairs( const std::vector<CPhysicsObject *> &objects ) = 0;
+
+  /**
+   * Drops any state kept between calls.
+   */
+  virtual void reset();
+
+protected:
+  /**
+   * @param first
+   * @param second
+   * @return true if bounding circles of objects overlap.
+   */
+  static bool boundsOverlap( const CPhysicsObject &first, const CPhysicsObject &second );
+
+  /**
+   * Storage for found pairs, reused between calls.
+   */
+  std::vector<TCandidatePair> m_pairs;
+};
+
+/**
+ * Tests every pair of objects. O(n^2), kept for comparison.
+ */
+class CBruteForceBroadPhase : public CBroadPhase
+{
+public:
+  /**
+   * Tests all pairs of objects.
+   * @param objects
+   * @return Candidate pairs sorted by first, then by second index.
+   */
+  const std::vector<TCandidatePair> &findPairs( const std::vector<CPhysicsObject *> &objects ) override;
+};
+
+/**
+ * Sweep and prune along x axis.
+ * Order of objects is kept between calls, so insertion sort
+ * runs in nearly linear time when objects move only a little.
+ */
+class CSweepAndPruneBroadPhase : public CBroadPhase
+{
+public:
+  /**
+   * Updates sorted order of bounding intervals and sweeps it.
+   * @param objects
+   * @return Candidate pairs sorted by first, then by second index.
+   */
+  const std::vector<TCandidatePair> &findPairs( const std::vector<CPhysicsObject *> &objects ) override;
+
+  /**
+   * Forgets sorted order.
+   */
+  void reset() override;
+
+private:
+  /**
+   * Object indices sorted by left end of bounding interval.
+   */
+  std::vector<size_t> m_order;
+
+  /**
+   * Left end of bounding interval of each object.
+   */
+  std::vector<TScalar> m_min;
+
+  /**
+   * Right end of bounding interval of each object.
+   */
+  std::vector<TScalar> m_max;
+};
+
+/**
+ * Uniform grid of square cells, every object is inserted to all cells
+ * overlapped by its bounding box. Objects with unbounded extent are paired with all objects.
+ */
+class CUniformGridBroadPhase : public CBroadPhase
+{
+public:
+  /**
+   * Constructs grid with cells of cellSize.
+   * @param cellSize
+   */
+  explicit CUniformGridBroadPhase( TScalar cellSize = 64 );
+
+  /**
+   * Rebuilds grid and collects pairs sharing a cell.
+   * @param objects
+   * @return Candidate pairs sorted by first, then by second index.
+   */
+  const std::vector<TCandidatePair> &findPairs( const std::vector<CPhysicsObject *> &objects ) override;
+
+  /**
+   * Drops all cells.
+   */
+  void reset() override;
+
+private:
+  /**
+   * @param x, y cell coordinates
+   * @return Key of cell.
+   */
+  static uint64_t cellKey( int64_t x, int64_t y );
+
+  /**
+   * Side of single cell.
+   */
+  TScalar m_cellSize;
+
+  /**
+   * Cell key and object index of each object in each cell it overlaps, sorted.
+   * Rebuilt each search, capacity is kept.
+   */
+  std::vector<std::pair<uint64_t, size_t>> m_cells;
+
+  /**
+   * Objects too large to be stored in grid.
+   */
+  std::vector<size_t> m_unbounded;
+};
@@ -6,8 +6,9 @@
 using namespace std;
 using namespace collision;
 
-CCircle::CCircle( TVector<2> centre, double size, double density )
-  : CPhysicsObject( centre,
+CCircle::CCircle( TVector<2> centre, TScalar size, TScalar density )
+  : CPhysicsObject( EShapeType::CIRCLE,
+                    centre,
                     TPhysicsAttributes::circleAttributes( density, size ) ),
     m_radius( size )
 {
@@ -41,22 +42,30 @@ TManifold CCircle::getManifold( CComplexObject *other )
   return other->getManifold( this );
 }
 
-CPhysicsObject &CCircle::rotate( double angle )
+CPhysicsObject &CCircle::rotate( TScalar angle )
 {
   return CPhysicsObject::rotate( angle );
 }
 
-double CCircle::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
+TScalar CCircle::sweep( const CRectangle &rectangle, const TVector<2> &startPosition, TScalar ) const
+{
+  if( startPosition.distance( m_position ) < m_radius / 2 )
+    return HUGE_VAL;
+  return sweepCircleRect( startPosition, m_position, m_radius,
+                          rectangle.m_position, rectangle.m_size, rectangle.m_rotation );
+}
+
+TScalar CCircle::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
 {
   if( CPhysicsObject::rayTrace( position, direction ) == HUGE_VAL )
     return HUGE_VAL;
   return rayTrace( position, direction, m_position, m_radius );
 }
 
-double CCircle::rayTrace( const TVector<2> &position,
-                          const TVector<2> &direction,
-                          const TVector<2> &centre,
-                          double radius )
+TScalar CCircle::rayTrace( const TVector<2> &position,
+                           const TVector<2> &direction,
+                           const TVector<2> &centre,
+                           TScalar radius )
 {
   TVector<2> unit = direction.normalized();
   TVector<2> chordHeight = ( centre - position ).rejectedFrom( unit );
@@ -64,12 +73,12 @@ double CCircle::rayTrace( const TVector<2> &position,
     return HUGE_VAL;
 
   TVector<2> chordCentre = ( centre - position ).projectedTo( unit );
-  double chordHalfLength = sqrt( radius * radius - chordHeight.squareNorm() );
+  TScalar chordHalfLength = sqrt( radius * radius - chordHeight.squareNorm() );
   TVector<2> chordStart = chordCentre - unit.stretchedTo( chordHalfLength );
   TVector<2> chordEnd = chordCentre + unit.stretchedTo( chordHalfLength );
 
-  double startDistance = unit.dot( chordStart );
-  double endDistance = unit.dot( chordEnd );
+  TScalar startDistance = unit.dot( chordStart );
+  TScalar endDistance = unit.dot( chordEnd );
   if( startDistance * endDistance <= 0 )
     return 0;
   if( startDistance < 0 )
@@ -14,7 +14,7 @@ public:
    * @param radius radius of circle
    * @param density circle density
    */
-  CCircle( TVector<2> centre, double radius, double density );
+  CCircle( TVector<2> centre, TScalar radius, TScalar density );
 
   /**
    * Renders circle to window.
@@ -27,7 +27,7 @@ public:
    * @param angle angle to rotate object
    * @return CPhysicsObject instance.
    */
-  CPhysicsObject &rotate( double angle ) override;
+  CPhysicsObject &rotate( TScalar angle ) override;
 
   /**
    * Calculates collision manifold with other object.
@@ -61,10 +61,22 @@ public:
    * Calculates largest distance ray can travel from position in direction.
    * @param position
    * @param direction
-   * @return Non-negative double.
+   * @return Non-negative scalar.
    */
-  [[nodiscard]] double rayTrace( const TVector<2> &position,
-                                 const TVector<2> &direction ) const override;
+  [[nodiscard]] TScalar rayTrace( const TVector<2> &position,
+                                  const TVector<2> &direction ) const override;
+
+  /**
+   * Calculates time of impact of circle moving from start position with rectangle.
+   * Movement shorter than half of radius is not swept, discrete collision handles it.
+   * @param rectangle obstacle
+   * @param startPosition position at start of step
+   * @param startRotation rotation at start of step
+   * @return Fraction of movement done before first touch, HUGE_VAL if there is no impact.
+   */
+  [[nodiscard]] TScalar sweep( const CRectangle &rectangle,
+                               const TVector<2> &startPosition,
+                               TScalar startRotation ) const override;
 
   /**
    * Calculates largest distance ray can travel from position in direction
@@ -75,15 +87,15 @@ public:
    * @param radius
    * @return
    */
-  [[nodiscard]] static double rayTrace( const TVector<2> &position,
-                                        const TVector<2> &direction,
-                                        const TVector<2> &centre,
-                                        double radius );
+  [[nodiscard]] static TScalar rayTrace( const TVector<2> &position,
+                                         const TVector<2> &direction,
+                                         const TVector<2> &centre,
+                                         TScalar radius );
 
   /**
    * Circle radius.
    */
-  double m_radius;
+  TScalar m_radius;
 };
 
 
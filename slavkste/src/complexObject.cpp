@@ -6,8 +6,8 @@
 using namespace std;
 using namespace collision;
 
-CComplexObject::CComplexObject( double width )
-        : CPhysicsObject( {}, { HUGE_VAL, HUGE_VAL } ),
+CComplexObject::CComplexObject( TScalar width )
+        : CPhysicsObject( EShapeType::COMPLEX, {}, TPhysicsAttributes( HUGE_VAL, HUGE_VAL ) ),
           m_width( width ){}
 
 void CComplexObject::render( CWindow &win ) const
@@ -28,7 +28,7 @@ TVector<2> CComplexObject::calculateCentreOfMass( const vector<TVector<2>> &vert
     return {};
   else if( vertices.size() == 1 )
     return vertices[ 0 ];
-  double weight = 0;
+  TScalar weight = 0;
   TVector<2> weightedPosition;
   for( size_t idx = 1; idx < vertices.size(); ++idx )
   {
@@ -50,52 +50,46 @@ TManifold CComplexObject::getManifold( CRectangle *rect )
   if( m_vertices.empty() )
     return { nullptr, nullptr };
 
-  vector<TContactPoint> contacts;
-  vector<size_t> collidingFaces;
+  TFrameVector<TContactPoint> contacts;
+  TFrameVector<size_t> faces, vertices, collidingFaces;
+  TMatrix<2, 4> rectCorners = rect->corners();
+  nearbyFeatures( TBoundingBox::around( rectCorners ), faces, vertices );
 
-  for( size_t idx = 1; idx < m_vertices.size(); ++idx )
+  for( size_t face: faces )
   {
-    const auto &begin = m_vertices[ idx - 1 ];
-    const auto &end = m_vertices[ idx ];
+    const auto &begin = m_vertices[ face ];
+    const auto &end = m_vertices[ face + 1 ];
     const auto direction = end - begin;
-    TContactPoint contact = rectRect( rect->m_position,
-                                      rect->m_size,
-                                      rect->m_rotation,
-                                      m_position + ( begin + end ) / 2,
-                                      { direction.norm() / 2, m_width },
-                                      direction.getAngle() );
+    TVector<2> facePosition = m_position + ( begin + end ) / 2;
+    TVector<2> faceSize{ direction.norm() / 2, m_width };
+    if( rect->m_position.distance( facePosition ) > rect->m_size.norm() + faceSize.norm() )
+      continue;
+    TContactPoint contact = rectRect( rect->m_position, rect->m_shape,
+                                      facePosition, { faceSize, direction.getAngle() } );
     if( !contact.contactPoint )
       continue;
+    contact.feature += face * 32; // rectRect features are below 32
     contacts.push_back( contact );
-    collidingFaces.push_back( idx - 1 );
+    collidingFaces.push_back( face );
   }
 
-  auto faceIt = collidingFaces.begin();
-  for( size_t idx = 0; idx < m_vertices.size(); ++idx )
+  for( size_t idx: uncoveredVertices( vertices, collidingFaces ) )
   {
-    if( faceIt != collidingFaces.end() && ( *faceIt == idx || *faceIt == idx ) )
-    {
-      idx = *faceIt + 1;
-      ++faceIt;
-      continue;
-    }
-    TContactPoint contact = rectCircle( rect->m_position,
-                                        rect->m_size,
-                                        rect->m_rotation,
-                                        m_vertices[ idx ] + m_position, m_width );
+    TContactPoint contact = rectCircle( rectCorners, m_vertices[ idx ] + m_position, m_width );
     if( !contact.contactPoint )
       continue;
+    contact.feature = m_vertices.size() * 32 + idx;
     contacts.push_back( contact );
   }
 
-  return { rect, this, contacts };
+  return { rect, this, move( contacts ) };
 }
 
 TManifold CComplexObject::getManifold( CCircle *circle )
 {
   auto contacts = getCircleCollision( circle->m_position, circle->m_radius );
 
-  return { circle, this, contacts };
+  return { circle, this, move( contacts ) };
 }
 
 TManifold CComplexObject::getManifold( CComplexObject *other )
@@ -103,43 +97,58 @@ TManifold CComplexObject::getManifold( CComplexObject *other )
   if( m_vertices.empty() || other->m_vertices.empty() )
     return { nullptr, nullptr };
 
-  vector<TContactPoint> contacts;
+  TFrameVector<TContactPoint> contacts;
+  // features: node of this x face of other, node of other x face of this, ends of other
+  size_t count = m_vertices.size();
+  size_t otherCount = other->m_vertices.size();
 
-  for( const auto &vertex: m_vertices )
+  for( size_t idx = 0; idx < count; ++idx )
   {
-    auto newContacts = getNodeCollisions( other, m_position + vertex );
+    auto newContacts = getNodeCollisions( other, m_position + m_vertices[ idx ] );
+    for_each( newContacts.begin(), newContacts.end(),
+              [ & ]( auto &elem ){ elem.feature += idx * otherCount; } );
     contacts.insert( contacts.end(), newContacts.begin(), newContacts.end() );
   }
 
-  for( const auto &vertex: other->m_vertices )
+  for( size_t idx = 0; idx < otherCount; ++idx )
   {
-    auto newContacts = other->getNodeCollisions( this, other->m_position + vertex );
-    for_each( newContacts.begin(), newContacts.end(),
-              []( auto &elem ){ elem.overlapVector *= -1; } );
+    auto newContacts = other->getNodeCollisions( this, other->m_position + other->m_vertices[ idx ] );
+    for_each( newContacts.begin(), newContacts.end(), [ & ]( auto &elem )
+    {
+      elem.overlapVector *= -1;
+      elem.feature += count * otherCount + idx * count;
+    } );
     contacts.insert( contacts.end(), newContacts.begin(), newContacts.end() );
   }
 
+  size_t endFeature = 2 * count * otherCount;
   auto endContact = getCircleCollision( other->m_position + other->m_vertices.front(),
                                           other->m_width );
+  for_each( endContact.begin(), endContact.end(),
+            [ & ]( auto &elem ){ elem.feature += endFeature; } );
   contacts.insert( contacts.end(), endContact.begin(), endContact.end() );
   if( other->m_vertices.size() > 1 )
   {
     auto startContact = getCircleCollision( other->m_position + other->m_vertices.back(),
                                             other->m_width );
+    for_each( startContact.begin(), startContact.end(),
+              [ & ]( auto &elem ){ elem.feature += endFeature + 2 * count; } );
     contacts.insert( contacts.end(), startContact.begin(), startContact.end() );
   }
 
-  return { other, this, contacts };
+  return { other, this, move( contacts ) };
 }
 
-std::vector<TContactPoint> CComplexObject::getNodeCollisions( CComplexObject *other,
+TFrameVector<TContactPoint> CComplexObject::getNodeCollisions( CComplexObject *other,
                                                               const TVector<2> &node ) const
 {
-  vector<TContactPoint> contacts;
-  for( size_t faceIdx = 1; faceIdx < other->m_vertices.size(); ++faceIdx )
+  TFrameVector<TContactPoint> contacts;
+  TFrameVector<size_t> faces;
+  other->m_tree.query( TBoundingBox::around( node - other->m_position, m_width ), faces );
+  for( size_t face: faces )
   {
-    const auto &begin = other->m_vertices[ faceIdx - 1 ];
-    const auto &end = other->m_vertices[ faceIdx ];
+    const auto &begin = other->m_vertices[ face ];
+    const auto &end = other->m_vertices[ face + 1 ];
     const auto direction = end - begin;
     TContactPoint contact = rectCircle( other->m_position + ( begin + end ) / 2,
                                         { direction.norm() / 2, other->m_width },
@@ -147,17 +156,39 @@ std::vector<TContactPoint> CComplexObject::getNodeCollisions( CComplexObject *ot
                                         node, m_width );
     if( !contact.contactPoint )
       continue;
+    contact.feature = face;
     contacts.push_back( contact );
   }
   return contacts;
 }
 
-CPhysicsObject &CComplexObject::rotate( double angle )
+CPhysicsObject &CComplexObject::rotate( TScalar angle )
 {
   auto rot = TMatrix<2, 2>::rotationMatrix2D( angle );
   for( TVector<2> &vertex: m_vertices )
     vertex = rot * vertex;
-  return *this;
+  m_tree.refit( m_vertices );
+  return CPhysicsObject::rotate( angle );
+}
+
+TScalar CComplexObject::sweep( const CRectangle &rectangle,
+                               const TVector<2> &startPosition,
+                               TScalar startRotation ) const
+{
+  auto rot = TMatrix<2, 2>::rotationMatrix2D( startRotation - m_rotation );
+  TScalar firstImpact = HUGE_VAL;
+  for( const auto &vertex: m_vertices )
+  {
+    TVector<2> start = startPosition + rot * vertex;
+    TVector<2> end = m_position + vertex;
+    if( start.distance( end ) < m_width / 2 )
+      continue;
+    firstImpact = min( firstImpact, sweepCircleRect( start, end, m_width,
+                                                     rectangle.m_position,
+                                                     rectangle.m_size,
+                                                     rectangle.m_rotation ) );
+  }
+  return firstImpact;
 }
 
 void CComplexObject::addVertex( const TVector<2> &point )
@@ -165,25 +196,81 @@ void CComplexObject::addVertex( const TVector<2> &point )
   TVector<2> newPoint = point - m_position;
   if( !m_vertices.empty() )
   {
-    double length = newPoint.distance( m_vertices.back() );
+    TScalar length = newPoint.distance( m_vertices.back() );
     if( length > m_longest )
       m_longest = length;
   }
   m_vertices.push_back( newPoint );
 }
 
-double CComplexObject::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
+size_t CComplexObject::simplify( TScalar tolerance )
+{
+  size_t count = m_vertices.size();
+  if( count < 3 )
+    return 0;
+
+  vector<char> keep( count, false );
+  keep.front() = keep.back() = true;
+  vector<pair<size_t, size_t>> ranges{ { 0, count - 1 } };
+  while( !ranges.empty() )
+  {
+    auto [ first, last ] = ranges.back();
+    ranges.pop_back();
+    const auto &begin = m_vertices[ first ];
+    const auto &end = m_vertices[ last ];
+    TScalar farthest = tolerance;
+    size_t farthestIdx = first;
+    for( size_t idx = first + 1; idx < last; ++idx )
+    {
+      // closed strip has same first and last vertex
+      TVector<2> closest = begin.squareDistance( end ) > 0
+                           ? lineSegmentClosestPoint( begin, end, m_vertices[ idx ] )
+                           : begin;
+      TScalar distance = closest.distance( m_vertices[ idx ] );
+      if( distance <= farthest )
+        continue;
+      farthest = distance;
+      farthestIdx = idx;
+    }
+    if( farthestIdx == first )
+      continue;
+    keep[ farthestIdx ] = true;
+    ranges.emplace_back( first, farthestIdx );
+    ranges.emplace_back( farthestIdx, last );
+  }
+
+  size_t kept = 0;
+  for( size_t idx = 0; idx < count; ++idx )
+    if( keep[ idx ] )
+      m_vertices[ kept++ ] = m_vertices[ idx ];
+  m_vertices.resize( kept );
+
+  m_longest = 0;
+  for( size_t idx = 1; idx < kept; ++idx )
+    m_longest = max( m_longest, m_vertices[ idx ].distance( m_vertices[ idx - 1 ] ) );
+  m_tree.build( m_vertices, m_width );
+  return count - kept;
+}
+
+size_t CComplexObject::vertexCount() const
+{
+  return m_vertices.size();
+}
+
+TScalar CComplexObject::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
 {
   if( CPhysicsObject::rayTrace( position, direction ) == HUGE_VAL )
     return HUGE_VAL;
   if( m_vertices.empty() )
     return HUGE_VAL;
-  double smallest = HUGE_VAL;
-  for( auto it = m_vertices.begin() + 1; it != m_vertices.end(); ++it )
+  TScalar smallest = HUGE_VAL;
+  TFrameVector<size_t> faces;
+  m_tree.query( position - m_position, direction, faces );
+  for( size_t face: faces )
   {
-    TVector<2> normal = crossProduct( *it - *( it - 1 ) ).stretchedTo( m_width );
-    TVector<2> back = m_position + *it;
-    TVector<2> front = m_position + *( it - 1 );
+    TVector<2> normal = crossProduct( m_vertices[ face + 1 ] - m_vertices[ face ] ).stretchedTo( m_width );
+    TVector<2> back = m_position + m_vertices[ face + 1 ];
+    TVector<2> front = m_position + m_vertices[ face ];
     smallest = min( smallest, CRectangle::rayTrace( position, direction,
                                                     { back + normal,
                                                       back - normal,
@@ -193,8 +280,8 @@ double CComplexObject::rayTrace( const TVector<2> &position, const TVector<2> &d
   for( auto centre: { m_vertices.front(),
                       m_vertices.back() } )
   {
-    double rayLen = CCircle::rayTrace( position, direction,
-                                       m_position + centre, m_width );
+    TScalar rayLen = CCircle::rayTrace( position, direction,
+                                        m_position + centre, m_width );
     if( rayLen < 0 )
       continue;
     smallest = min( smallest, rayLen );
@@ -202,7 +289,7 @@ double CComplexObject::rayTrace( const TVector<2> &position, const TVector<2> &d
   return smallest;
 }
 
-void CComplexObject::spawn( double density )
+void CComplexObject::spawn( TScalar density )
 {
   TVector<2> massCentreOffset = calculateCentreOfMass( m_vertices );
   m_position += massCentreOffset;
@@ -214,6 +301,8 @@ void CComplexObject::spawn( double density )
       m_boundingRadius = vertex.norm() + m_width;
   }
 
+  m_tree.build( m_vertices, m_width );
+
   m_longest = sqrt( 0.25 * m_longest * m_longest + m_width * m_width );
 
   if( isnan( density ) )
@@ -225,17 +314,18 @@ void CComplexObject::spawn( double density )
                                                               m_vertices );
 }
 
-std::vector<TContactPoint> CComplexObject::getCircleCollision( const TVector<2> &centre, double radius ) const
+TFrameVector<TContactPoint> CComplexObject::getCircleCollision( const TVector<2> &centre, TScalar radius ) const
 {
   if( m_vertices.empty() )
     return {};
 
-  vector<TContactPoint> contacts;
-  vector<size_t> collidingFaces;
-  for( size_t idx = 1; idx < m_vertices.size(); ++idx )
+  TFrameVector<TContactPoint> contacts;
+  TFrameVector<size_t> faces, vertices, collidingFaces;
+  nearbyFeatures( TBoundingBox::around( centre, radius ), faces, vertices );
+  for( size_t face: faces )
   {
-    const auto &begin = m_vertices[ idx - 1 ];
-    const auto &end = m_vertices[ idx ];
+    const auto &begin = m_vertices[ face ];
+    const auto &end = m_vertices[ face + 1 ];
     const auto direction = end - begin;
     TContactPoint contact = rectCircle( m_position + ( begin + end ) / 2,
                                         { direction.norm() / 2, m_width },
@@ -245,28 +335,69 @@ std::vector<TContactPoint> CComplexObject::getCircleCollision( const TVector<2>
     if( !contact.contactPoint )
       continue;
     contact.overlapVector *= -1;
+    contact.feature = face;
     contacts.push_back( contact );
-    collidingFaces.push_back( idx - 1 );
+    collidingFaces.push_back( face );
   }
 
-  auto faceIt = collidingFaces.begin();
-  for( size_t idx = 0; idx < m_vertices.size(); ++idx )
+  for( size_t idx: uncoveredVertices( vertices, collidingFaces ) )
   {
-    if( faceIt != collidingFaces.end() && ( *faceIt == idx || *faceIt == idx ) )
-    {
-      idx = *faceIt + 1;
-      ++faceIt;
-      continue;
-    }
     TContactPoint contact = circleCircle( centre,
                                           radius,
                                           m_vertices[ idx ] + m_position,
                                           m_width );
     if( !contact.contactPoint )
       continue;
+    contact.feature = m_vertices.size() + idx;
     contacts.push_back( contact );
   }
 
   return contacts;
 }
 
+void CComplexObject::nearbyFeatures( const TBoundingBox &box,
+                                     TFrameVector<size_t> &faces,
+                                     TFrameVector<size_t> &vertices ) const
+{
+  TBoundingBox localBox{ box.min - m_position, box.max - m_position };
+  if( m_tree.empty() )
+  {
+    if( localBox.overlaps( TBoundingBox::around( m_vertices[ 0 ], m_width ) ) )
+      vertices.push_back( 0 );
+    return;
+  }
+
+  m_tree.query( localBox, faces );
+  for( size_t face: faces )
+  {
+    if( vertices.empty() || vertices.back() != face )
+      vertices.push_back( face );
+    vertices.push_back( face + 1 );
+  }
+}
+
+TFrameVector<size_t> CComplexObject::uncoveredVertices( const TFrameVector<size_t> &vertices,
+                                                  const TFrameVector<size_t> &collidingFaces )
+{
+  // both ends of colliding face are covered,
+  // faces starting in already covered vertex and all following faces are ignored
+  TFrameVector<size_t> covered;
+  for( size_t face: collidingFaces )
+  {
+    if( !covered.empty() && face <= covered.back() )
+      break;
+    covered.push_back( face );
+    covered.push_back( face + 1 );
+  }
+
+  TFrameVector<size_t> uncovered;
+  auto coveredIt = covered.begin();
+  for( size_t vertex: vertices )
+  {
+    while( coveredIt != covered.end() && *coveredIt < vertex )
+      ++coveredIt;
+    if( coveredIt == covered.end() || *coveredIt != vertex )
+      uncovered.push_back( vertex );
+  }
+  return uncovered;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "physicsObject.hpp"
+#include "segmentTree.hpp"
 
 /**
  * Class for representing solid line strip with fixed joints.
@@ -14,13 +15,14 @@ public:
    * Density is initialised to HUGE_VAL
    * @param width half width of lines( radius of joint circles )
    */
-  explicit CComplexObject( double width );
+  explicit CComplexObject( TScalar width );
 
   /**
    * Recalculates objects centre of mass, position, mass, angular mass
+   * and builds face tree.
    * @param density new density of object
    */
-  void spawn( double density = HUGE_VAL );
+  void spawn( TScalar density = HUGE_VAL );
 
   /**
    * Renders complex object to window.
@@ -31,12 +33,12 @@ public:
 
   /**
    * Method for performing rotation on complex object.
-   * Updates all vertices to rotate around centre of mass. Leaves rotation as 0.
+   * Updates all vertices to rotate around centre of mass and refits face tree.
    * Should not be called before spawn.
    * @param angle angle to rotate object
    * @return CPhysicsObject instance.
    */
-  CPhysicsObject &rotate( double angle ) override;
+  CPhysicsObject &rotate( TScalar angle ) override;
 
   /**
    * Calculates collision manifold with other object.
@@ -67,38 +69,66 @@ public:
   TManifold getManifold( CComplexObject *other ) override;
 
   /**
-   * Calculates collisions with circle.
+   * Calculates collisions with circle. Feature of contact is face index
+   * or vertex count + vertex index.
    * @param centre circle centre
    * @param radius circle radius
    * @return Vector of collision points.
    */
-  [[nodiscard]] std::vector<TContactPoint> getCircleCollision( const TVector<2> &centre,
-                                                               double radius ) const;
+  [[nodiscard]] TFrameVector<TContactPoint> getCircleCollision( const TVector<2> &centre,
+                                                               TScalar radius ) const;
 
   /**
-   * Calculates node collisions with other complex.
+   * Calculates node collisions with other complex. Feature of contact is face index of other.
    * @param complexObject other complex object
    * @param node node position of complex object
    * @return Vector of collision points.
    */
-  std::vector<TContactPoint> getNodeCollisions( CComplexObject *complexObject,
+  TFrameVector<TContactPoint> getNodeCollisions( CComplexObject *complexObject,
                                                 const TVector<2> &node ) const;
 
   /**
    * Calculates largest distance ray can travel from position in direction.
    * @param position position
    * @param direction direction
-   * @return Positive double.
+   * @return Positive scalar.
    */
-  [[nodiscard]] double rayTrace( const TVector<2> &position,
-                                 const TVector<2> &direction ) const override;
+  [[nodiscard]] TScalar rayTrace( const TVector<2> &position,
+                                  const TVector<2> &direction ) const override;
 
   /**
-   * Adds new vertex to object.
+   * Calculates time of impact of joints moving from start pose with rectangle.
+   * Joints move along straight line, joints moving less than half of width are not swept.
+   * @param rectangle obstacle
+   * @param startPosition position at start of step
+   * @param startRotation rotation at start of step
+   * @return Fraction of movement done before first touch of any joint,
+   * HUGE_VAL if there is no impact.
+   */
+  [[nodiscard]] TScalar sweep( const CRectangle &rectangle,
+                               const TVector<2> &startPosition,
+                               TScalar startRotation ) const override;
+
+  /**
+   * Adds new vertex to object. Face tree is not updated until simplify or spawn,
+   * so object must not collide nor be ray traced while vertices are added.
    * @param vertex position relative to coordinates origin.
    */
   void addVertex( const TVector<2> &vertex );
 
+  /**
+   * Removes vertices of line strip which deviate less than tolerance from simplified strip
+   * ( Douglas-Peucker ). First and last vertex are kept. Should not be called after spawn.
+   * @param tolerance largest allowed distance of removed vertex from simplified strip
+   * @return Number of removed vertices.
+   */
+  size_t simplify( TScalar tolerance );
+
+  /**
+   * @return Number of vertices.
+   */
+  [[nodiscard]] size_t vertexCount() const;
+
   /**
    * Calculates centre of mass of homogenous line strip.
    * @param vertices vector of vertices
@@ -109,17 +139,42 @@ public:
   /**
    * Half-width of lines, radius of joints.
    */
-  double m_width;
+  TScalar m_width;
 
   /**
    * Longest line in line strip.
    * Allows optimisations when calculating collisions.
    */
-  double m_longest = 0;
+  TScalar m_longest = 0;
 private:
+  /**
+   * Finds faces whose bounding box overlaps box and vertices at their ends.
+   * @param box box in scene coordinates
+   * @param faces storage for face indices, ascending
+   * @param vertices storage for vertex indices, ascending
+   */
+  void nearbyFeatures( const TBoundingBox &box,
+                       TFrameVector<size_t> &faces,
+                       TFrameVector<size_t> &vertices ) const;
+
+  /**
+   * Filters vertices which are not covered by colliding faces.
+   * Vertices at both ends of colliding face do not need own contact.
+   * @param vertices ascending vertex indices
+   * @param collidingFaces ascending face indices
+   * @return Ascending indices of vertices to test.
+   */
+  static TFrameVector<size_t> uncoveredVertices( const TFrameVector<size_t> &vertices,
+                                                const TFrameVector<size_t> &collidingFaces );
+
   /**
    * Object vertices.
    */
   std::vector<TVector<2>> m_vertices;
+
+  /**
+   * Bounding volume hierarchy over faces, in object space. Built by simplify and spawn.
+   */
+  CSegmentTree m_tree;
 };
 
@@ -0,0 +1,109 @@
+#include "contactCache.hpp"
+
+
+using namespace std;
+
+const size_t CContactCache::minCapacity = 16;
+
+size_t CContactCache::TPairKeyHash::operator()( const TPairKey &key ) const
+{
+  return std::hash<const CPhysicsObject *>()( key.first ) * 31 +
+         std::hash<const CPhysicsObject *>()( key.second );
+}
+
+void CContactCache::update( const TManifoldList &manifolds, size_t frame )
+{
+  for( size_t idx = 0; idx < manifolds.size(); ++idx )
+  {
+    const auto &manifold = manifolds[ idx ];
+    auto it = m_pairs.find( TPairKey{ manifold.first, manifold.second } );
+    bool inserted = it == m_pairs.end();
+    if( inserted )
+      it = insert( manifold, frame );
+    it->second.lastFrame = frame;
+    it->second.lastManifold = idx;
+    if( inserted && m_beginCallback )
+      m_beginCallback( manifold );
+  }
+
+  for( auto it = m_pairs.begin(); it != m_pairs.end(); )
+  {
+    auto &pair = it->second;
+    if( pair.lastFrame == frame )
+    {
+      if( m_endCallback )
+      {
+        const auto &contacts = manifolds[ pair.lastManifold ].contacts;
+        pair.manifold.contacts.assign( contacts.begin(), contacts.end() );
+      }
+      ++it;
+      continue;
+    }
+    if( restingPair( *pair.manifold.first, *pair.manifold.second ) )
+    {
+      ++it;
+      continue;
+    }
+    if( m_endCallback )
+      m_endCallback( pair.manifold );
+    auto next = std::next( it );
+    m_freeNodes.push_back( m_pairs.extract( it ) );
+    it = next;
+  }
+}
+
+CContactCache::TPairMap::iterator CContactCache::insert( const TManifold &manifold, size_t frame )
+{
+  if( m_freeNodes.empty() )
+    grow();
+
+  auto node = move( m_freeNodes.back() );
+  m_freeNodes.pop_back();
+  node.key() = { manifold.first, manifold.second };
+  node.mapped().manifold.first = manifold.first;
+  node.mapped().manifold.second = manifold.second;
+  node.mapped().manifold.contacts.clear();
+  node.mapped().beginFrame = frame;
+  return m_pairs.insert( move( node ) ).position;
+}
+
+void CContactCache::grow()
+{
+  size_t capacity = max( 2 * m_pairs.size(), minCapacity );
+  m_pairs.reserve( capacity );
+  m_freeNodes.reserve( capacity );
+  TPairMap spare;
+  while( m_pairs.size() + m_freeNodes.size() < capacity )
+  {
+    spare.try_emplace( TPairKey{ nullptr, nullptr }, TContactPair{ { nullptr, nullptr }, 0, 0, 0 } );
+    m_freeNodes.push_back( spare.extract( spare.begin() ) );
+  }
+}
+
+void CContactCache::setBeginCallback( TContactCallback callback )
+{
+  m_beginCallback = move( callback );
+}
+
+void CContactCache::setEndCallback( TContactCallback callback )
+{
+  m_endCallback = move( callback );
+}
+
+void CContactCache::reset()
+{
+  while( !m_pairs.empty() )
+    m_freeNodes.push_back( m_pairs.extract( m_pairs.begin() ) );
+}
+
+size_t CContactCache::size() const
+{
+  return m_pairs.size();
+}
+
+bool CContactCache::restingPair( const CPhysicsObject &first, const CPhysicsObject &second )
+{
+  return ( first.m_sleeping || second.m_sleeping ) &&
+         ( first.m_sleeping || first.m_attributes.invMass == 0 ) &&
+         ( second.m_sleeping || second.m_attributes.invMass == 0 );
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+
+/**
+ * Persistent cache of touching object pairs.
+ * Keeps each touching pair between frames and reports beginning and end of contact
+ * between two objects. Contacts of pair are copied to its retained storage, once per frame
+ * from last manifold of pair, only while end callback is set.
+ * Cached objects must not be deleted without reset.
+ */
+class CContactCache
+{
+public:
+  /**
+   * Function called with manifold of pair which started or stopped touching.
+   */
+  using TContactCallback = std::function<void( const TManifold & )>;
+
+  /**
+   * Updates pairs by manifolds found in frame. Pairs seen for the first time are reported
+   * to begin callback with manifold from frame, pairs not seen anymore are reported to end callback and forgotten.
+   * Resting pairs, which engine does not test, stay cached.
+   * @param manifolds all manifolds found in frame, pair may be present multiple times
+   * @param frame frame number
+   */
+  void update( const TManifoldList &manifolds, size_t frame );
+
+  /**
+   * @param callback function called when pair starts touching
+   */
+  void setBeginCallback( TContactCallback callback );
+
+  /**
+   * @param callback function called when pair stops touching, with last manifold of pair.
+   * Pairs which were touching before callback was set are reported without contacts.
+   */
+  void setEndCallback( TContactCallback callback );
+
+  /**
+   * Forgets all pairs, their nodes are kept for reuse. End callback is not called.
+   */
+  void reset();
+
+  /**
+   * @return Number of touching pairs.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * Pair of objects which are not moving does not have to be tested,
+   * its cached contact persists.
+   * Static pairs are still tested, because static objects may be moved outside engine.
+   * @param first
+   * @param second
+   * @return true if both objects are sleeping or static and at least one is sleeping.
+   */
+  static bool restingPair( const CPhysicsObject &first, const CPhysicsObject &second );
+
+private:
+  /**
+   * Touching pair of objects.
+   */
+  struct TContactPair
+  {
+    /**
+     * Objects of pair and, while end callback is set, contacts of last manifold of pair.
+     */
+    TManifold manifold;
+
+    /**
+     * Frame in which pair started touching.
+     */
+    size_t beginFrame;
+
+    /**
+     * Last frame in which manifold of pair was found.
+     */
+    size_t lastFrame;
+
+    /**
+     * Index of last manifold of pair in manifolds of last frame.
+     */
+    size_t lastManifold;
+  };
+
+  using TPairKey = std::pair<const CPhysicsObject *, const CPhysicsObject *>;
+
+  struct TPairKeyHash
+  {
+    size_t operator()( const TPairKey &key ) const;
+  };
+
+  using TPairMap = std::unordered_map<TPairKey, TContactPair, TPairKeyHash>;
+
+  /**
+   * Inserts pair seen for the first time into node of forgotten pair,
+   * nodes are added by grow when there is none.
+   * @param manifold manifold of pair
+   * @param frame
+   * @return Iterator to inserted pair.
+   */
+  TPairMap::iterator insert( const TManifold &manifold, size_t frame );
+
+  /**
+   * Doubles number of nodes and buckets, so pair count reaching new peak
+   * allocates only when it doubles.
+   */
+  void grow();
+
+  /**
+   * Number of nodes allocated by first grow.
+   */
+  static const size_t minCapacity;
+
+  /**
+   * All touching pairs.
+   */
+  TPairMap m_pairs;
+
+  /**
+   * Nodes of forgotten pairs and spare nodes, kept with their contact storage,
+   * so pairs starting to touch do not allocate.
+   */
+  std::vector<TPairMap::node_type> m_freeNodes;
+
+  /**
+   * Contact callbacks, may be empty.
+   */
+  TContactCallback m_beginCallback, m_endCallback;
+};
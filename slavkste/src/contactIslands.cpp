@@ -0,0 +1,114 @@
+#include "contactIslands.hpp"
+#include <algorithm>
+#include <numeric>
+
+
+using namespace std;
+
+/**
+ * @param manifold
+ * @return true if collision is resolved.
+ */
+static bool isSolid( const TManifold &manifold )
+{
+  return !( manifold.first->m_tag & ETag::NON_SOLID ||
+            manifold.second->m_tag & ETag::NON_SOLID );
+}
+
+/**
+ * @param object
+ * @return true if object is moved by collisions.
+ */
+static bool isDynamic( const CPhysicsObject *object )
+{
+  return object->m_attributes.invMass != 0;
+}
+
+void CContactIslands::build( const TManifoldList &manifolds )
+{
+  m_bodies.clear();
+  for( const auto &manifold: manifolds )
+  {
+    if( !isSolid( manifold ) )
+      continue;
+    for( const CPhysicsObject *body: { manifold.first, manifold.second } )
+      if( isDynamic( body ) )
+        m_bodies.push_back( body );
+  }
+  sort( m_bodies.begin(), m_bodies.end(), less<const CPhysicsObject *>() );
+  m_bodies.erase( unique( m_bodies.begin(), m_bodies.end() ), m_bodies.end() );
+  reserveDoubling( m_parent, m_bodies.size() );
+  m_parent.resize( m_bodies.size() );
+  iota( m_parent.begin(), m_parent.end(), 0 );
+
+  for( const auto &manifold: manifolds )
+  {
+    if( !isSolid( manifold ) ||
+        !isDynamic( manifold.first ) || !isDynamic( manifold.second ) )
+      continue;
+    size_t firstRoot = findRoot( bodyIndex( manifold.first ) );
+    size_t secondRoot = findRoot( bodyIndex( manifold.second ) );
+    m_parent[ secondRoot ] = firstRoot;
+  }
+
+  reserveDoubling( m_rootIsland, m_parent.size() );
+  m_rootIsland.assign( m_parent.size(), SIZE_MAX );
+  for( size_t island = 0; island < m_size; ++island )
+    m_islands[ island ].clear();
+  m_size = 0;
+
+  for( size_t idx = 0; idx < manifolds.size(); ++idx )
+  {
+    const auto &manifold = manifolds[ idx ];
+    if( !isSolid( manifold ) )
+      continue;
+    const CPhysicsObject *body = isDynamic( manifold.first ) ? manifold.first : manifold.second;
+    if( !isDynamic( body ) )
+      continue;
+
+    size_t root = findRoot( bodyIndex( body ) );
+    if( m_rootIsland[ root ] == SIZE_MAX )
+    {
+      m_rootIsland[ root ] = m_size++;
+      if( m_islands.size() < m_size )
+        m_islands.emplace_back();
+    }
+    m_islands[ m_rootIsland[ root ] ].push_back( idx );
+  }
+}
+
+size_t CContactIslands::size() const
+{
+  return m_size;
+}
+
+const vector<size_t> &CContactIslands::operator[]( size_t island ) const
+{
+  return m_islands[ island ];
+}
+
+size_t CContactIslands::islandOf( const CPhysicsObject *object )
+{
+  size_t body = bodyIndex( object );
+  if( body == SIZE_MAX )
+    return SIZE_MAX;
+  return m_rootIsland[ findRoot( body ) ];
+}
+
+size_t CContactIslands::bodyIndex( const CPhysicsObject *object ) const
+{
+  auto it = lower_bound( m_bodies.begin(), m_bodies.end(), object, less<const CPhysicsObject *>() );
+  if( it == m_bodies.end() || *it != object )
+    return SIZE_MAX;
+  return it - m_bodies.begin();
+}
+
+size_t CContactIslands::findRoot( size_t body )
+{
+  while( m_parent[ body ] != body )
+  {
+    m_parent[ body ] = m_parent[ m_parent[ body ] ];
+    body = m_parent[ body ];
+  }
+  return body;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <vector>
+#include <cstdint>
+
+
+/**
+ * Splits collision manifolds to islands, groups of manifolds that share no moving object.
+ * Static objects ( zero inverse mass ) are never changed by collision resolution,
+ * so they don't join islands. Islands can be resolved independently of each other.
+ */
+class CContactIslands
+{
+public:
+  /**
+   * Finds islands of solid manifolds. Manifolds between two static
+   * objects and manifolds with non-solid object are not part of any island.
+   * @param manifolds
+   */
+  void build( const TManifoldList &manifolds );
+
+  /**
+   * @return Number of islands.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * @param island island index
+   * @return Indices of manifolds in island, in same order as in built manifolds.
+   */
+  [[nodiscard]] const std::vector<size_t> &operator[]( size_t island ) const;
+
+  /**
+   * @param object
+   * @return Island containing object, SIZE_MAX if object has no solid collision.
+   */
+  size_t islandOf( const CPhysicsObject *object );
+
+private:
+  /**
+   * @param object
+   * @return Index of object in union-find, SIZE_MAX if object is not in any solid manifold.
+   */
+  [[nodiscard]] size_t bodyIndex( const CPhysicsObject *object ) const;
+
+  /**
+   * @param body
+   * @return Representative of body set.
+   */
+  size_t findRoot( size_t body );
+
+  /**
+   * Union-find parent of each body.
+   */
+  std::vector<size_t> m_parent;
+
+  /**
+   * Island of each union-find root.
+   */
+  std::vector<size_t> m_rootIsland;
+
+  /**
+   * Dynamic objects of solid manifolds, sorted. Index of object is its index in union-find.
+   */
+  std::vector<const CPhysicsObject *> m_bodies;
+
+  /**
+   * Manifold indices of each island. Vectors past m_size are kept for reuse.
+   */
+  std::vector<std::vector<size_t>> m_islands;
+
+  /**
+   * Number of islands.
+   */
+  size_t m_size = 0;
+};
@@ -0,0 +1,160 @@
+#include "contactSolver.hpp"
+#include <algorithm>
+
+
+using namespace std;
+
+const TScalar CContactSolver::restitutionVelocity = 10;
+
+bool TSolverSettings::iterative() const
+{
+  return velocityIterations != 1 || warmStarting;
+}
+
+bool CContactSolver::TContactKey::operator==( const TContactKey &other ) const
+{
+  return first == other.first && second == other.second && feature == other.feature;
+}
+
+bool CContactSolver::TContactKey::operator<( const TContactKey &other ) const
+{
+  less<const CPhysicsObject *> pointerLess;
+  if( first != other.first )
+    return pointerLess( first, other.first );
+  if( second != other.second )
+    return pointerLess( second, other.second );
+  return feature < other.feature;
+}
+
+void CContactSolver::prepare( const TManifoldList &manifolds, bool warmStarting )
+{
+  m_contacts.clear();
+  m_firstContact.clear();
+  for( const auto &manifold: manifolds )
+  {
+    m_firstContact.push_back( m_contacts.size() );
+    const auto &firstAttr = manifold.first->m_attributes;
+    const auto &secondAttr = manifold.second->m_attributes;
+    for( const auto &contactPoint: manifold.contacts )
+    {
+      TSolverContact contact{};
+      contact.normal = contactPoint.overlapVector.normalized();
+      contact.tangent = crossProduct( contact.normal );
+      contact.normalMass = getMass( manifold, contactPoint.contactPoint, contact.normal );
+      contact.tangentMass = getMass( manifold, contactPoint.contactPoint, contact.tangent );
+      contact.friction = sqrt( firstAttr.frictionCoefficient * secondAttr.frictionCoefficient );
+
+      const TCachedImpulse *cached = warmStarting ? findCached( { manifold.first, manifold.second,
+                                                                  contactPoint.feature } )
+                                                  : nullptr;
+      // only new contacts bounce, persisting contacts are resting or sliding
+      TVector<2> relativeVelocity = manifold.second->getLocalVelocity( contactPoint.contactPoint ) -
+                                    manifold.first->getLocalVelocity( contactPoint.contactPoint );
+      TScalar approachVelocity = contact.normal.dot( relativeVelocity );
+      if( approachVelocity < -restitutionVelocity && !cached )
+        contact.targetVelocity = -firstAttr.elasticity * secondAttr.elasticity * approachVelocity;
+
+      if( cached )
+      {
+        contact.normalImpulse = cached->normalImpulse;
+        contact.tangentImpulse = cached->tangentImpulse;
+        contact.warmImpulse = contact.normalImpulse * contact.normal +
+                              contact.tangentImpulse * contact.tangent;
+        applyImpulse( manifold, contactPoint.contactPoint, contact.warmImpulse );
+      }
+      m_contacts.push_back( contact );
+    }
+  }
+}
+
+void CContactSolver::solve( const TManifoldList &manifolds, size_t manifoldIdx )
+{
+  const auto &manifold = manifolds[ manifoldIdx ];
+  for( size_t idx = 0; idx < manifold.contacts.size(); ++idx )
+  {
+    auto &contact = m_contacts[ m_firstContact[ manifoldIdx ] + idx ];
+    const auto &point = manifold.contacts[ idx ].contactPoint;
+
+    TVector<2> relativeVelocity = manifold.second->getLocalVelocity( point ) -
+                                  manifold.first->getLocalVelocity( point );
+    TScalar normalImpulse = max<TScalar>( contact.normalImpulse -
+                                         ( contact.normal.dot( relativeVelocity ) - contact.targetVelocity ) *
+                                         contact.normalMass, 0 );
+    applyImpulse( manifold, point, ( normalImpulse - contact.normalImpulse ) * contact.normal );
+    contact.normalImpulse = normalImpulse;
+
+    relativeVelocity = manifold.second->getLocalVelocity( point ) -
+                       manifold.first->getLocalVelocity( point );
+    TScalar frictionLimit = contact.friction * contact.normalImpulse;
+    TScalar tangentImpulse = clamp( contact.tangentImpulse -
+                                    contact.tangent.dot( relativeVelocity ) * contact.tangentMass,
+                                    -frictionLimit, frictionLimit );
+    applyImpulse( manifold, point, ( tangentImpulse - contact.tangentImpulse ) * contact.tangent );
+    contact.tangentImpulse = tangentImpulse;
+  }
+}
+
+void CContactSolver::finish( const TManifoldList &manifolds )
+{
+  m_cache.clear();
+  for( size_t manifoldIdx = 0; manifoldIdx < manifolds.size(); ++manifoldIdx )
+  {
+    const auto &manifold = manifolds[ manifoldIdx ];
+    if( manifold.first->m_tag & ETag::NON_SOLID ||
+        manifold.second->m_tag & ETag::NON_SOLID )
+      continue;
+    for( size_t idx = 0; idx < manifold.contacts.size(); ++idx )
+    {
+      const auto &contact = m_contacts[ m_firstContact[ manifoldIdx ] + idx ];
+      TVector<2> impulse = contact.normalImpulse * contact.normal +
+                           contact.tangentImpulse * contact.tangent - contact.warmImpulse;
+      manifold.first->applyDamage( -impulse );
+      manifold.second->applyDamage( impulse );
+      m_cache.push_back( { { manifold.first, manifold.second, manifold.contacts[ idx ].feature },
+                           m_cache.size(), contact.normalImpulse, contact.tangentImpulse } );
+    }
+  }
+  sort( m_cache.begin(), m_cache.end(), []( const TCachedImpulse &a, const TCachedImpulse &b )
+  {
+    return a.key < b.key || ( a.key == b.key && a.order < b.order );
+  } );
+}
+
+void CContactSolver::reset()
+{
+  m_cache.clear();
+}
+
+const CContactSolver::TCachedImpulse *CContactSolver::findCached( const TContactKey &key ) const
+{
+  auto it = upper_bound( m_cache.begin(), m_cache.end(), key, []( const TContactKey &key,
+                                                                  const TCachedImpulse &cached )
+  {
+    return key < cached.key;
+  } );
+  if( it == m_cache.begin() || !( prev( it )->key == key ) )
+    return nullptr;
+  return &*prev( it );
+}
+
+void CContactSolver::applyImpulse( const TManifold &manifold,
+                                   const TVector<2> &point,
+                                   const TVector<2> &impulse )
+{
+  manifold.first->applyVelocityImpulse( -impulse, point );
+  manifold.second->applyVelocityImpulse( impulse, point );
+}
+
+TScalar CContactSolver::getMass( const TManifold &manifold,
+                                 const TVector<2> &point,
+                                 const TVector<2> &direction )
+{
+  TScalar invMass = 0;
+  for( const CPhysicsObject *object: { manifold.first, manifold.second } )
+  {
+    TVector<2> lever = point - object->m_position;
+    invMass += object->m_attributes.invMass +
+               pow( lever.dot( crossProduct( direction ) ), 2 ) * object->m_attributes.invAngularMass;
+  }
+  return invMass > 0 ? 1 / invMass : 0;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <vector>
+
+
+/**
+ * Settings of collision response.
+ */
+struct TSolverSettings
+{
+  /**
+   * Number of sequential impulse passes over all contacts.
+   */
+  size_t velocityIterations = 1;
+
+  /**
+   * Number of collision searches followed by positional correction.
+   */
+  size_t positionIterations = 1;
+
+  /**
+   * Starts impulse of persisting contacts from impulse of last frame.
+   */
+  bool warmStarting = false;
+
+  /**
+   * @return true if iterative solver is needed, false for original single impulse pass.
+   */
+  [[nodiscard]] bool iterative() const;
+};
+
+/**
+ * Sequential impulse solver. Impulse of each contact is accumulated over iterations
+ * and clamped, so contacts never pull objects together and friction stays in friction cone.
+ * Accumulated impulses are cached by object pair and contact feature for warm starting.
+ */
+class CContactSolver
+{
+public:
+  /**
+   * Prepares contacts of manifolds for solving and applies warm starting impulses.
+   * @param manifolds
+   * @param warmStarting
+   */
+  void prepare( const TManifoldList &manifolds, bool warmStarting );
+
+  /**
+   * Does one impulse pass over contacts of manifold.
+   * Manifolds without shared objects can be solved concurrently.
+   * @param manifolds same manifolds as in prepare
+   * @param manifold index of manifold
+   */
+  void solve( const TManifoldList &manifolds, size_t manifold );
+
+  /**
+   * Damages objects by impulses added in this frame and stores impulses for warm starting.
+   * Impulse carried by warm starting holds resting objects, it does not cause damage.
+   * @param manifolds same manifolds as in prepare
+   */
+  void finish( const TManifoldList &manifolds );
+
+  /**
+   * Forgets cached impulses.
+   */
+  void reset();
+
+private:
+  /**
+   * Contact prepared for solving.
+   */
+  struct TSolverContact
+  {
+    /**
+     * Collision normal ( towards second object ) and tangent.
+     */
+    TVector<2> normal, tangent;
+
+    /**
+     * Inverted combined inverse masses in normal and tangent direction.
+     */
+    TScalar normalMass, tangentMass;
+
+    /**
+     * Normal velocity after collision.
+     */
+    TScalar targetVelocity;
+
+    /**
+     * Friction coefficient.
+     */
+    TScalar friction;
+
+    /**
+     * Accumulated impulses applied to second object. ( Negative to first )
+     */
+    TScalar normalImpulse, tangentImpulse;
+
+    /**
+     * Impulse applied by warm starting.
+     */
+    TVector<2> warmImpulse;
+  };
+
+  /**
+   * Identifies contact between frames.
+   */
+  struct TContactKey
+  {
+    const CPhysicsObject *first, *second;
+    size_t feature;
+
+    bool operator==( const TContactKey &other ) const;
+
+    bool operator<( const TContactKey &other ) const;
+  };
+
+  /**
+   * Impulses of contact stored for next frame.
+   */
+  struct TCachedImpulse
+  {
+    TContactKey key;
+
+    /**
+     * Order of storing, later impulse of same contact replaces earlier.
+     */
+    size_t order;
+
+    TScalar normalImpulse, tangentImpulse;
+  };
+
+  /**
+   * Approach velocity below which contacts do not bounce.
+   */
+  static const TScalar restitutionVelocity;
+
+  /**
+   * Applies impulse to both objects at contact point.
+   * @param manifold
+   * @param point contact point
+   * @param impulse impulse applied to second object
+   */
+  static void applyImpulse( const TManifold &manifold,
+                            const TVector<2> &point,
+                            const TVector<2> &impulse );
+
+  /**
+   * @param manifold
+   * @param point
+   * @param direction normalized direction
+   * @return Inverse of combined inverse masses, 0 if both objects are static.
+   */
+  static TScalar getMass( const TManifold &manifold,
+                          const TVector<2> &point,
+                          const TVector<2> &direction );
+
+  /**
+   * Prepared contacts of all manifolds.
+   */
+  std::vector<TSolverContact> m_contacts;
+
+  /**
+   * Index of first contact of each manifold in m_contacts.
+   */
+  std::vector<size_t> m_firstContact;
+
+  /**
+   * @param key
+   * @return Last impulse stored for contact in last frame, nullptr if there is none.
+   */
+  [[nodiscard]] const TCachedImpulse *findCached( const TContactKey &key ) const;
+
+  /**
+   * Impulses of contacts from last frame, sorted by key and order.
+   * Sorted vector is refilled each frame without allocating.
+   */
+  std::vector<TCachedImpulse> m_cache;
+};
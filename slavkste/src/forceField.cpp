@@ -4,19 +4,134 @@
 using namespace std;
 
 CForceField::CForceField( function<void( CPhysicsObject & )> functor )
-  : m_fieldFunctor( move( functor ) )
+  : m_type( EFieldType::FUNCTOR ),
+    m_fieldFunctor( move( functor ) )
+{}
+
+CForceField::CForceField( EFieldType type )
+  : m_type( type )
 {}
 
 void CForceField::applyForce( CPhysicsObject &obj ) const
 {
-  m_fieldFunctor( obj );
+  if( m_fieldFunctor )
+    m_fieldFunctor( obj );
+}
+
+void CForceField::applyForces( TBodyStore &bodies ) const
+{
+  switch( m_type )
+  {
+    case EFieldType::UNIFORM:
+      applyUniform( bodies );
+      break;
+    case EFieldType::RADIAL:
+      applyRadial( bodies );
+      break;
+    case EFieldType::DRAG:
+      applyDrag( bodies );
+      break;
+    case EFieldType::WIND:
+      applyWind( bodies );
+      break;
+    case EFieldType::FUNCTOR:
+      break;
+  }
+}
+
+CForceField CForceField::gravitationalField( TScalar g )
+{
+  return uniformField( { 0, -g } );
+}
+
+CForceField CForceField::uniformField( const TVector<2> &acceleration )
+{
+  CForceField field( EFieldType::UNIFORM );
+  field.m_vector = acceleration;
+  return field;
+}
+
+CForceField CForceField::radialField( const TVector<2> &centre, TScalar strength, TScalar radius )
+{
+  CForceField field( EFieldType::RADIAL );
+  field.m_vector = centre;
+  field.m_strength = strength;
+  field.m_radius = radius;
+  return field;
+}
+
+CForceField CForceField::dragField( TScalar coefficient )
+{
+  CForceField field( EFieldType::DRAG );
+  field.m_strength = coefficient;
+  return field;
+}
+
+CForceField CForceField::windField( const TVector<2> &min, const TVector<2> &max,
+                                    const TVector<2> &velocity, TScalar coefficient )
+{
+  CForceField field( EFieldType::WIND );
+  field.m_min = min;
+  field.m_max = max;
+  field.m_vector = velocity;
+  field.m_strength = coefficient;
+  return field;
+}
+
+void CForceField::applyUniform( TBodyStore &bodies ) const
+{
+  TScalar accelerationX = m_vector[ 0 ], accelerationY = m_vector[ 1 ];
+  for( size_t idx = 0; idx < bodies.size(); ++idx )
+  {
+    if( bodies.invMass[ idx ] == 0 || bodies.sleeping[ idx ] )
+      continue;
+    bodies.forceX[ idx ] += bodies.mass[ idx ] * accelerationX;
+    bodies.forceY[ idx ] += bodies.mass[ idx ] * accelerationY;
+  }
+}
+
+void CForceField::applyRadial( TBodyStore &bodies ) const
+{
+  TScalar centreX = m_vector[ 0 ], centreY = m_vector[ 1 ];
+  for( size_t idx = 0; idx < bodies.size(); ++idx )
+  {
+    if( bodies.invMass[ idx ] == 0 || bodies.sleeping[ idx ] )
+      continue;
+    TScalar offsetX = centreX - bodies.positionX[ idx ];
+    TScalar offsetY = centreY - bodies.positionY[ idx ];
+    TScalar distance = sqrt( offsetX * offsetX + offsetY * offsetY );
+    if( distance == 0 || distance > m_radius )
+      continue;
+    TScalar scale = bodies.mass[ idx ] * m_strength / distance;
+    bodies.forceX[ idx ] += offsetX * scale;
+    bodies.forceY[ idx ] += offsetY * scale;
+  }
+}
+
+void CForceField::applyDrag( TBodyStore &bodies ) const
+{
+  for( size_t idx = 0; idx < bodies.size(); ++idx )
+  {
+    if( bodies.invMass[ idx ] == 0 || bodies.sleeping[ idx ] )
+      continue;
+    TScalar scale = m_strength * bodies.mass[ idx ];
+    bodies.forceX[ idx ] -= scale * bodies.velocityX[ idx ];
+    bodies.forceY[ idx ] -= scale * bodies.velocityY[ idx ];
+    if( bodies.invAngularMass[ idx ] != 0 )
+      bodies.moment[ idx ] -= m_strength * bodies.angularVelocity[ idx ] / bodies.invAngularMass[ idx ];
+  }
 }
 
-CForceField CForceField::gravitationalField( double g )
+void CForceField::applyWind( TBodyStore &bodies ) const
 {
-  return CForceField( [ g ]( CPhysicsObject &object )
-                      {
-                        object.m_attributes.forceAccumulator +=
-                                g * object.m_attributes.mass * TVector<2>{ 0, -1 };
-                      } );
+  for( size_t idx = 0; idx < bodies.size(); ++idx )
+  {
+    if( bodies.invMass[ idx ] == 0 || bodies.sleeping[ idx ] ||
+        bodies.positionX[ idx ] < m_min[ 0 ] || bodies.positionX[ idx ] > m_max[ 0 ] ||
+        bodies.positionY[ idx ] < m_min[ 1 ] || bodies.positionY[ idx ] > m_max[ 1 ] )
+      continue;
+    TScalar scale = m_strength * bodies.mass[ idx ];
+    bodies.forceX[ idx ] += scale * ( m_vector[ 0 ] - bodies.velocityX[ idx ] );
+    bodies.forceY[ idx ] += scale * ( m_vector[ 1 ] - bodies.velocityY[ idx ] );
+  }
 }
@@ -1,6 +1,20 @@
 #pragma once
 
 #include "physicsObject.hpp"
+#include "bodyStore.hpp"
+
+/**
+ * Kinds of force fields. Built-in kinds are applied by loop over all bodies,
+ * fields given by function are applied to each object separately.
+ */
+enum class EFieldType : uint8_t
+{
+  FUNCTOR,
+  UNIFORM,
+  RADIAL,
+  DRAG,
+  WIND
+};
 
 /**
  * Class for representing forces.
@@ -15,20 +29,112 @@ public:
   explicit CForceField( std::function<void( CPhysicsObject &object )> function );
 
   /**
-   * Applies force field to object.
+   * Applies field function to object. Built-in fields are applied only by applyForces.
    * @param object Object to apply force to.
    */
   void applyForce( CPhysicsObject &object ) const;
 
+  /**
+   * Adds force of built-in field to force accumulators of all awake movable bodies.
+   * @param bodies
+   */
+  void applyForces( TBodyStore &bodies ) const;
+
   /**
    * Returns gravitational field with acceleration g.
    * @param g acceleration
    * @return CForceField global homogenous gravitational field.
    */
-  static CForceField gravitationalField( double g = 50 );
+  static CForceField gravitationalField( TScalar g = 50 );
+
+  /**
+   * @param acceleration
+   * @return Homogenous field accelerating all bodies by acceleration.
+   */
+  static CForceField uniformField( const TVector<2> &acceleration );
 
   /**
-   * Field function/functor.
+   * @param centre
+   * @param strength acceleration towards centre, negative strength pushes bodies away
+   * @param radius bodies farther from centre are not affected
+   * @return Field accelerating bodies towards centre.
+   */
+  static CForceField radialField( const TVector<2> &centre, TScalar strength, TScalar radius = HUGE_VAL );
+
+  /**
+   * @param coefficient deceleration per unit of velocity
+   * @return Field slowing down all bodies.
+   */
+  static CForceField dragField( TScalar coefficient );
+
+  /**
+   * @param min lower left corner of region
+   * @param max upper right corner of region
+   * @param velocity wind velocity
+   * @param coefficient acceleration per unit of velocity relative to wind
+   * @return Field dragging bodies with centre inside region towards velocity of wind.
+   */
+  static CForceField windField( const TVector<2> &min, const TVector<2> &max,
+                                const TVector<2> &velocity, TScalar coefficient );
+
+  /**
+   * Kind of field.
+   */
+  EFieldType m_type;
+
+  /**
+   * Field function/functor, empty for built-in fields.
    */
   std::function<void( CPhysicsObject & )> m_fieldFunctor;
+
+private:
+  /**
+   * Creates built-in field without parameters.
+   * @param type
+   */
+  explicit CForceField( EFieldType type );
+
+  /**
+   * Adds mass times acceleration to all bodies.
+   * @param bodies
+   */
+  void applyUniform( TBodyStore &bodies ) const;
+
+  /**
+   * Adds force towards centre to bodies in radius.
+   * @param bodies
+   */
+  void applyRadial( TBodyStore &bodies ) const;
+
+  /**
+   * Adds force against velocity and moment against angular velocity to all bodies.
+   * @param bodies
+   */
+  void applyDrag( TBodyStore &bodies ) const;
+
+  /**
+   * Adds force towards wind velocity to bodies in region.
+   * @param bodies
+   */
+  void applyWind( TBodyStore &bodies ) const;
+
+  /**
+   * Acceleration of uniform field, centre of radial field or velocity of wind.
+   */
+  TVector<2> m_vector;
+
+  /**
+   * Region of wind field.
+   */
+  TVector<2> m_min, m_max;
+
+  /**
+   * Strength of radial field or coefficient of drag and wind.
+   */
+  TScalar m_strength = 0;
+
+  /**
+   * Radius of radial field.
+   */
+  TScalar m_radius = HUGE_VAL;
 };
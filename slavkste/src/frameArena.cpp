@@ -0,0 +1,88 @@
+#include "frameArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+
+using namespace std;
+
+thread_local CFrameArena *CFrameArena::s_active = nullptr;
+
+CFrameArena::CFrameArena( size_t blockSize )
+  : m_blockSize( blockSize )
+{}
+
+void *CFrameArena::allocate( size_t size, size_t alignment )
+{
+  auto address = reinterpret_cast<uintptr_t>( m_current );
+  size_t padding = ( alignment - address % alignment ) % alignment;
+  if( !m_current || (size_t)( m_end - m_current ) < padding + size )
+  {
+    addBlock( size, alignment );
+    address = reinterpret_cast<uintptr_t>( m_current );
+    padding = ( alignment - address % alignment ) % alignment;
+  }
+  void *memory = m_current + padding;
+  m_current += padding + size;
+  return memory;
+}
+
+void CFrameArena::reset()
+{
+  if( m_blocks.size() > 1 )
+  {
+    size_t total = capacity();
+    m_blocks.clear();
+    m_blocks.push_back( { make_unique<byte[]>( total ), total } );
+    ++m_blockAllocations;
+  }
+  m_usedBefore = 0;
+  m_current = m_blocks.empty() ? nullptr : m_blocks.back().data.get();
+  m_end = m_blocks.empty() ? nullptr : m_current + m_blocks.back().size;
+}
+
+size_t CFrameArena::used() const
+{
+  if( m_blocks.empty() )
+    return 0;
+  return m_usedBefore + ( m_current - m_blocks.back().data.get() );
+}
+
+size_t CFrameArena::capacity() const
+{
+  size_t total = 0;
+  for( const auto &block: m_blocks )
+    total += block.size;
+  return total;
+}
+
+size_t CFrameArena::blockAllocations() const
+{
+  return m_blockAllocations;
+}
+
+void CFrameArena::addBlock( size_t size, size_t alignment )
+{
+  m_usedBefore = used();
+  size_t blockSize = max( { m_blockSize, size + alignment,
+                            m_blocks.empty() ? 0 : m_blocks.back().size * 2 } );
+  m_blocks.push_back( { make_unique<byte[]>( blockSize ), blockSize } );
+  ++m_blockAllocations;
+  m_current = m_blocks.back().data.get();
+  m_end = m_current + blockSize;
+}
+
+CFrameArena *CFrameArena::active()
+{
+  return s_active;
+}
+
+CFrameArena::CScope::CScope( CFrameArena &arena )
+  : m_previous( s_active )
+{
+  s_active = &arena;
+}
+
+CFrameArena::CScope::~CScope()
+{
+  s_active = m_previous;
+}
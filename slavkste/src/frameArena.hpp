@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+
+
+/**
+ * Bump allocator for temporaries of single physics step. Memory is only
+ * released all at once by reset. After reset arena keeps one block large enough
+ * for everything allocated since previous reset, so steps with same
+ * demand allocate nothing from heap.
+ */
+class CFrameArena
+{
+public:
+  /**
+   * @param blockSize size of first block in bytes
+   */
+  explicit CFrameArena( size_t blockSize = 1 << 16 );
+  CFrameArena( const CFrameArena & ) = delete;
+  CFrameArena &operator=( const CFrameArena & ) = delete;
+
+  /**
+   * Allocates memory valid until next reset.
+   * @param size size in bytes
+   * @param alignment power of two
+   * @return Aligned memory.
+   */
+  void *allocate( size_t size, size_t alignment );
+
+  /**
+   * Releases all memory allocated since previous reset.
+   * Blocks are merged to single block if more than one was needed.
+   */
+  void reset();
+
+  /**
+   * @return Bytes allocated since last reset, alignment included.
+   */
+  [[nodiscard]] size_t used() const;
+
+  /**
+   * @return Total size of blocks.
+   */
+  [[nodiscard]] size_t capacity() const;
+
+  /**
+   * @return Number of blocks allocated from heap during arena lifetime.
+   */
+  [[nodiscard]] size_t blockAllocations() const;
+
+  /**
+   * Makes arena active on current thread for lifetime of scope.
+   * Previously active arena is restored at end of scope.
+   */
+  class CScope
+  {
+  public:
+    /**
+     * @param arena arena to activate
+     */
+    explicit CScope( CFrameArena &arena );
+    CScope( const CScope & ) = delete;
+    CScope &operator=( const CScope & ) = delete;
+
+    ~CScope();
+  private:
+    /**
+     * Arena active before scope.
+     */
+    CFrameArena *m_previous;
+  };
+
+  /**
+   * @return Arena active on current thread, nullptr if there is none.
+   */
+  static CFrameArena *active();
+
+private:
+  /**
+   * Allocates new block, which fits at least size bytes with alignment.
+   * @param size
+   * @param alignment
+   */
+  void addBlock( size_t size, size_t alignment );
+
+  /**
+   * Memory block.
+   */
+  struct TBlock
+  {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+
+  /**
+   * Blocks, last one is being filled.
+   */
+  std::vector<TBlock> m_blocks;
+
+  /**
+   * Free part of last block.
+   */
+  std::byte *m_current = nullptr, *m_end = nullptr;
+
+  /**
+   * Bytes used in blocks before last one.
+   */
+  size_t m_usedBefore = 0;
+
+  /**
+   * Size of first block.
+   */
+  size_t m_blockSize;
+
+  /**
+   * Number of blocks allocated from heap.
+   */
+  size_t m_blockAllocations = 0;
+
+  /**
+   * Arena active on thread.
+   */
+  static thread_local CFrameArena *s_active;
+};
+
+/**
+ * Allocator taking memory from frame arena. Default constructed allocator uses arena
+ * active on current thread, or heap if there is none. Copies of containers use arena
+ * active at time of copy, so temporaries copied out of physics step do not point to arena.
+ * @tparam T allocated type
+ */
+template <typename T>
+class CFrameAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /**
+   * Allocator of active arena.
+   */
+  CFrameAllocator()
+    : m_arena( CFrameArena::active() )
+  {}
+
+  /**
+   * @param arena arena, nullptr for heap
+   */
+  explicit CFrameAllocator( CFrameArena *arena )
+    : m_arena( arena )
+  {}
+
+  template <typename U>
+  CFrameAllocator( const CFrameAllocator<U> &other )
+    : m_arena( other.arena() )
+  {}
+
+  T *allocate( size_t count )
+  {
+    if( !m_arena )
+      return std::allocator<T>().allocate( count );
+    return static_cast<T *>( m_arena->allocate( count * sizeof( T ), alignof( T ) ) );
+  }
+
+  void deallocate( T *pointer, size_t count )
+  {
+    if( !m_arena )
+      std::allocator<T>().deallocate( pointer, count );
+  }
+
+  [[nodiscard]] CFrameAllocator select_on_container_copy_construction() const
+  {
+    return {};
+  }
+
+  /**
+   * @return Arena of allocator, nullptr for heap.
+   */
+  [[nodiscard]] CFrameArena *arena() const
+  {
+    return m_arena;
+  }
+
+  template <typename U>
+  bool operator==( const CFrameAllocator<U> &other ) const
+  {
+    return m_arena == other.arena();
+  }
+
+  template <typename U>
+  bool operator!=( const CFrameAllocator<U> &other ) const
+  {
+    return m_arena != other.arena();
+  }
+
+private:
+  /**
+   * Arena of allocator, nullptr for heap.
+   */
+  CFrameArena *m_arena;
+};
+
+/**
+ * Vector of temporaries, allocated in arena active at its construction.
+ */
+template <typename T>
+using TFrameVector = std::vector<T, CFrameAllocator<T>>;
+
+/**
+ * Reserves capacity of vector kept between steps before it is resized or assigned.
+ * Capacity at least doubles when it grows, so steps reaching new peak size
+ * allocate only when peak doubles.
+ * @tparam vector_t
+ * @param vector
+ * @param size size vector is going to have
+ */
+template <typename vector_t>
+void reserveDoubling( vector_t &vector, size_t size )
+{
+  if( size > vector.capacity() )
+    vector.reserve( std::max( size, 2 * vector.capacity() ) );
+}
@@ -1,9 +1,12 @@
 #include "game.hpp"
 #include "text.hpp"
+#include <cstring>
 
 
 using namespace std;
 
+const string CGame::firstLevelFileName = "assets/tutorial_1.json";
+
 CGame::CGame( int *argcPtr, char *argv[] )
         : m_window( argcPtr, argv ),
           m_painter( [ this ](){ redraw(); } ),
@@ -12,9 +15,48 @@ CGame::CGame( int *argcPtr, char *argv[] )
                          m_objects,
                          m_text,
                          m_painter,
-                         "assets/tutorial_1.json" )
+                         firstLevelFileName )
+{
+  init();
+  // glut arguments are already removed by window
+  for( int idx = 1; idx + 1 < *argcPtr; ++idx )
+    if( !strcmp( argv[ idx ], "--record" ) )
+      record( argv[ idx + 1 ] );
+}
+
+CGame::CGame( const string &levelFileName )
+        : m_painter( [ this ](){ redraw(); } ),
+          m_levelLoader( m_window,
+                         m_engine,
+                         m_objects,
+                         m_text,
+                         m_painter,
+                         levelFileName )
+{
+  init();
+}
+
+CGame::CGame( const string &levelFileName, unique_ptr<CRenderer> renderer, int width, int height )
+        : m_window( move( renderer ), width, height ),
+          m_painter( [ this ](){ redraw(); } ),
+          m_levelLoader( m_window,
+                         m_engine,
+                         m_objects,
+                         m_text,
+                         m_painter,
+                         levelFileName )
+{
+  init();
+}
+
+void CGame::init()
 {
   m_levelLoader.loadLevel();
+  m_engine.setSleeping( true );
+  m_engine.setContactBeginCallback( [ this ]( const TManifold &contact )
+  {
+    m_targetReached = m_targetReached || checkCollision( contact );
+  } );
 
   m_window.registerDrawEvent( this, &CGame::redraw );
   m_window.registerKeyEvent( this, &CGame::keyPress );
@@ -24,6 +66,7 @@ CGame::CGame( int *argcPtr, char *argv[] )
 
 CGame::~CGame()
 {
+  recordEvent( { m_step, ESessionEvent::end, 0, 0, 0, stateHash() } );
   for( const auto &obj: m_objects )
     delete obj;
   for( const auto &text: m_text )
@@ -38,27 +81,69 @@ void CGame::nextFrame()
     return;
   }
 
-  vector<TManifold> collisions = m_engine.step( m_objects, frameLength / 1000 );
+  auto currentTime = getMilliseconds();
+  m_accumulator = min( m_accumulator + (double)( currentTime - lastFrame ),
+                       (double)maxSteps * frameLength );
+  lastFrame = currentTime;
+
+  while( m_accumulator >= frameLength )
+  {
+    m_accumulator -= frameLength;
+    if( !physicsStep() )
+      return;
+  }
+
+  setTimer();
+  redraw();
+}
+
+bool CGame::step()
+{
+  if( m_paused )
+    start();
+  return physicsStep();
+}
+
+bool CGame::physicsStep()
+{
+  storePoses();
+  m_targetReached = false;
+  m_engine.step( m_objects, frameLength / 1000 );
+  ++m_step;
   if( checkPlayerHealth() )
   {
     m_levelLoader.loadLevel( EActionType::resetLevel );
     pause();
+    return false;
   }
-  else if( checkCollisions( collisions ) )
+  if( m_targetReached )
   {
     m_levelLoader.loadLevel( EActionType::nextLevel );
     pause();
+    return false;
   }
   if( m_levelLoader.healthBar && !playerOnScreen() )
-    keyPress( 'r', 0, 0 );
-  setTimer();
-  redraw();
+  {
+    resetLevel();
+    return false;
+  }
+  return true;
+}
+
+void CGame::storePoses()
+{
+  m_poses.resize( m_objects.size() );
+  for( size_t idx = 0; idx < m_objects.size(); ++idx )
+    m_poses[ idx ] = { m_objects[ idx ]->m_position, m_objects[ idx ]->m_rotation };
 }
 
 void CGame::start()
 {
   m_paused = false;
   m_painter.stop();
+  m_accumulator = 0;
+  lastFrame = getMilliseconds();
+  storePoses();
   setTimer();
 }
 
@@ -70,14 +155,15 @@ void CGame::pause()
 
 void CGame::redraw()
 {
-  // Clear Color and Depth Buffers
-  glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+  if( !m_window.drawing() )
+    return;
 
-  // Reset transformations
-  glLoadIdentity();
+  m_window.clear();
 
-  for( const auto &obj: m_objects )
-    obj->render( m_window );
+  double alpha = m_accumulator / frameLength;
+  for( size_t idx = 0; idx < m_objects.size(); ++idx )
+    renderInterpolated( idx, alpha );
+  m_window.flush();
 
   if( !m_engine.frame )
     for( const auto &text: m_text )
@@ -85,8 +171,32 @@ void CGame::redraw()
 
   if( m_levelLoader.healthBar )
     drawHealthBar();
+  m_window.flush();
+  m_window.present();
+}
 
-  glutSwapBuffers();
+void CGame::renderInterpolated( size_t idx, double alpha )
+{
+  const auto &object = *m_objects[ idx ];
+  // poses are outdated while paused, objects may have been added or level loaded
+  if( m_paused || idx >= m_poses.size() )
+  {
+    object.render( m_window );
+    return;
+  }
+
+  const TPose &pose = m_poses[ idx ];
+  TVector<2> offset = ( pose.position - object.m_position ) * ( 1 - alpha );
+  double angle = ( pose.rotation - object.m_rotation ) * ( 1 - alpha );
+  if( offset.squareNorm() == 0 && angle == 0 )
+  {
+    object.render( m_window );
+    return;
+  }
+
+  m_window.pushTransform( object.m_position, angle, offset );
+  object.render( m_window );
+  m_window.popTransform();
 }
 
 void CGame::drawHealthBar()
@@ -108,7 +218,7 @@ void CGame::drawHealthBar()
 
   string health = to_string( (int)( 100 * player.m_attributes.integrity ) ) + '%';
 
-  m_window.drawText( { { screenSize[ 0 ] * 0.05, screenSize[ 1 ] * 0.95 } }, health );
+  m_window.drawText( { screenSize[ 0 ] * 0.05, screenSize[ 1 ] * 0.95 }, health );
 }
 
 
@@ -117,24 +227,85 @@ void CGame::mainLoop()
   m_window.mainLoop();
 }
 
+void CGame::record( const string &fileName )
+{
+  m_recorder = make_unique<CSessionRecorder>( fileName, m_levelLoader.levelFileName(),
+                                              CLevelLoader::levelHash( m_levelLoader.levelFileName() ) );
+}
+
+void CGame::replay( const CSessionLog &log )
+{
+  if( CLevelLoader::levelHash( log.levelFileName ) != log.levelHash )
+    throw invalid_argument( "Levels of session changed since recording, starting from "
+                            + log.levelFileName + ".\n" );
+  for( const auto &event: log.events )
+  {
+    while( m_step < event.step && !m_paused )
+      physicsStep();
+    switch( event.type )
+    {
+      case ESessionEvent::mouseDown:
+        clickHandler( GLUT_LEFT_BUTTON, GLUT_DOWN, event.x, event.y );
+        break;
+      case ESessionEvent::mouseUp:
+        clickHandler( GLUT_LEFT_BUTTON, GLUT_UP, event.x, event.y );
+        break;
+      case ESessionEvent::mouseMove:
+        moveHandler( event.x, event.y );
+        break;
+      case ESessionEvent::key:
+        keyPress( event.key, 0, 0 );
+        break;
+      case ESessionEvent::end:
+        break;
+    }
+  }
+}
+
+size_t CGame::steps() const
+{
+  return m_step;
+}
+
+const TStrokeStatistics &CGame::strokeStatistics() const
+{
+  return m_painter.statistics;
+}
+
+uint64_t CGame::stateHash() const
+{
+  return CSessionLog::stateHash( m_objects );
+}
+
+void CGame::recordEvent( TSessionEvent event )
+{
+  if( m_recorder )
+    m_recorder->record( event );
+}
+
 void CGame::keyPress( unsigned char key, int, int )
 {
+  recordEvent( { m_step, ESessionEvent::key, 0, 0, key } );
   if( key == 'p' )
     m_paused ? start() : pause();
-  if( key == 'q' )
+  if( key == 'q' && !m_window.headless() )
     glutLeaveMainLoop();
   if( key == 'r' )
-  {
-    m_levelLoader.loadLevel( EActionType::resetLevel );
-    pause();
-    pressed = false;
-  }
+    resetLevel();
+}
+
+void CGame::resetLevel()
+{
+  m_levelLoader.loadLevel( EActionType::resetLevel );
+  pause();
+  pressed = false;
 }
 
 void CGame::clickHandler( int button, int state, int x, int y )
 {
   if( button == GLUT_LEFT_BUTTON )
   {
+    recordEvent( { m_step, state == GLUT_DOWN ? ESessionEvent::mouseDown : ESessionEvent::mouseUp, x, y } );
     if( state == GLUT_DOWN )
     {
       drawPenalty( m_painter.addPoint( x, y, m_objects ) );
@@ -152,16 +323,10 @@ void CGame::clickHandler( int button, int state, int x, int y )
 
 void CGame::moveHandler( int x, int y )
 {
-  if( pressed )
-    drawPenalty( m_painter.addPoint( x, y, m_objects ) );
-}
-
-bool CGame::checkCollisions( const vector<TManifold> &collisions )
-{
-  return any_of( collisions.begin(), collisions.end(), []( const auto &collision )
-  {
-    return checkCollision( collision );
-  } );
+  if( !pressed )
+    return;
+  recordEvent( { m_step, ESessionEvent::mouseMove, x, y } );
+  drawPenalty( m_painter.addPoint( x, y, m_objects ) );
 }
 
 bool CGame::checkCollision( const TManifold &collision )
@@ -185,11 +350,8 @@ long CGame::getMilliseconds()
 
 void CGame::setTimer()
 {
-  auto currentTime = getMilliseconds();
-  long timeDiff = currentTime - lastFrame;
-  lastFrame = currentTime;
-
-  long sleepTime = (long)frameLength - timeDiff;
+  long timeDiff = getMilliseconds() - lastFrame;
+  long sleepTime = (long)renderLength - timeDiff;
   m_window.registerTimerEvent( this, &CGame::nextFrame, max( sleepTime, 0l ) );
 }
 
@@ -6,6 +6,7 @@
 #include "jsonParser.hpp"
 #include "painter.hpp"
 #include "object.hpp"
+#include "sessionLog.hpp"
 #include <cmath>
 #include <vector>
 #include <memory>
@@ -20,10 +21,26 @@ class CGame
 public:
   /**
    * Initialises game class.
+   * Program argument "--record file" records session to file.
    * @param argcPtr program arguments count pointer
    * @param argv program arguments array pointer
    */
   CGame( int *argcPtr, char *argv[] );
+
+  /**
+   * Initialises game without display for replaying sessions.
+   * @param levelFileName first level
+   */
+  explicit CGame( const std::string &levelFileName );
+
+  /**
+   * Initialises game without display drawing frames by renderer.
+   * Used for rendering benchmarks and image tests.
+   * @param levelFileName first level
+   * @param renderer
+   * @param width, height frame size in pixels
+   */
+  CGame( const std::string &levelFileName, std::unique_ptr<CRenderer> renderer, int width, int height );
   CGame( const CGame & ) = delete;
   CGame( CGame && ) = delete;
   CGame &operator=( const CGame & ) = delete;
@@ -37,29 +54,92 @@ public:
    */
   void mainLoop();
 
-private:
   /**
-   * Key press handler.
-   * @param key pressed key
-   * @param x, y position of mouse on key-press
+   * Starts recording of session in current level. Must be called before any input.
+   * @param fileName session log file
    */
-  void keyPress( unsigned char key, int x, int y );
+  void record( const std::string &fileName );
+
+  /**
+   * Replays recorded inputs, game must be created with first level of session.
+   * Physics steps run until step of each event, ends with step of last event.
+   * @param log recorded session
+   * @throws std::invalid_argument if levels of session changed since recording.
+   */
+  void replay( const CSessionLog &log );
+
+  /**
+   * Starts game if paused and performs one physics step. Used without display.
+   * @return false if level has ended.
+   */
+  bool step();
 
   /**
    * Redraws screen.
    */
   void redraw();
 
+  /**
+   * @return Number of physics steps since game start.
+   */
+  [[nodiscard]] size_t steps() const;
+
+  /**
+   * @return Simplification statistics of drawn strokes.
+   */
+  [[nodiscard]] const TStrokeStatistics &strokeStatistics() const;
+
+  /**
+   * @return State hash of game objects.
+   */
+  [[nodiscard]] uint64_t stateHash() const;
+
+  /**
+   * First level of game.
+   */
+  static const std::string firstLevelFileName;
+
+private:
+  /**
+   * Loads first level, sets up engine and registers event handlers.
+   */
+  void init();
+
+  /**
+   * Key press handler.
+   * @param key pressed key
+   * @param x, y position of mouse on key-press
+   */
+  void keyPress( unsigned char key, int x, int y );
+
   /**
    * Draws health-bar.
    */
   void drawHealthBar();
 
   /**
-   * Performs one game frame.
+   * Performs physics steps for time elapsed since last frame and redraws screen.
    */
   void nextFrame();
 
+  /**
+   * Performs one physics step.
+   * @return false if level has ended.
+   */
+  bool physicsStep();
+
+  /**
+   * Stores positions and rotations of objects before physics step.
+   */
+  void storePoses();
+
+  /**
+   * Renders object between its stored pose and current pose.
+   * @param idx index of object
+   * @param alpha 0 for stored pose, 1 for current pose
+   */
+  void renderInterpolated( size_t idx, double alpha );
+
   /**
    * Mouse click press/release handler.
    * @param button pressed/released button
@@ -80,16 +160,20 @@ private:
   void start();
 
   /**
-   * Pauses game.
+   * Restarts current level.
    */
-  void pause();
+  void resetLevel();
 
   /**
-   * Checks collision for completed checks.
-   * @param collisions collisions to check
-   * @return true if level has been successfully ended.
+   * Records input event if session is recorded.
+   * @param event
+   */
+  void recordEvent( TSessionEvent event );
+
+  /**
+   * Pauses game.
    */
-  static bool checkCollisions( const std::vector<TManifold> &collisions );
+  void pause();
 
   /**
    * Checks if collision wins level.
@@ -104,7 +188,7 @@ private:
   static long getMilliseconds();
 
   /**
-   * Starts timer for nextFrame call.
+   * Starts timer for nextFrame call, one render frame after last frame.
    */
   void setTimer();
 
@@ -129,21 +213,66 @@ private:
    */
   bool m_paused = true;
 
+  /**
+   * Player started touching target in last step.
+   */
+  bool m_targetReached = false;
+
   /**
    * Mouse button pressed.
    */
   bool pressed = false;
 
   /**
-   * Length of single game frame in milliseconds.
+   * Length of single physics step in milliseconds.
    */
   const double frameLength = 40; //ms
 
+  /**
+   * Time between two redraws in milliseconds.
+   */
+  const double renderLength = 16; //ms
+
+  /**
+   * Maximal number of physics steps in one frame.
+   * Simulation slows down instead of falling further behind.
+   */
+  const size_t maxSteps = 5;
+
   /**
    * Time of last game frame.
    */
   long lastFrame = 0;
 
+  /**
+   * Number of physics steps since game start.
+   */
+  size_t m_step = 0;
+
+  /**
+   * Session recorder, null if session is not recorded.
+   */
+  std::unique_ptr<CSessionRecorder> m_recorder;
+
+  /**
+   * Elapsed time in milliseconds not yet simulated.
+   */
+  double m_accumulator = 0;
+
+  /**
+   * Position and rotation of object.
+   */
+  struct TPose
+  {
+    TVector<2> position;
+    TScalar rotation;
+  };
+
+  /**
+   * Poses of objects before last physics step, used for render interpolation.
+   */
+  std::vector<TPose> m_poses;
+
   /**
    * Level window (_singleton_ instance)
    */
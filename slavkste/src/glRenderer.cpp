@@ -0,0 +1,90 @@
+#include "glRenderer.hpp"
+
+
+using namespace std;
+
+void CGLRenderer::setView( const TVector<2> &viewOrigin, const TVector<2> &viewExtreme,
+                           const TVector<2> &viewportOrigin, double scale )
+{
+  m_scale = scale;
+  TVector<2> viewSize = viewExtreme - viewOrigin;
+
+  // Use the Projection Matrix
+  glMatrixMode( GL_PROJECTION );
+
+  // Reset Matrix
+  glLoadIdentity();
+
+  // Set the viewport to show whole view
+  glViewport( (GLint)viewportOrigin[ 0 ],
+              (GLint)viewportOrigin[ 1 ],
+              (GLint)( scale * viewSize[ 0 ] ),
+              (GLint)( scale * viewSize[ 1 ] ) );
+
+  gluOrtho2D( viewOrigin[ 0 ], viewExtreme[ 0 ], viewOrigin[ 1 ], viewExtreme[ 1 ] );
+
+  // Get Back to the Model view
+  glMatrixMode( GL_MODELVIEW );
+}
+
+void CGLRenderer::clear()
+{
+  // Clear Color and Depth Buffers
+  glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+  // Reset transformations
+  glLoadIdentity();
+}
+
+void CGLRenderer::drawTriangles( const vector<float> &vertices, const TPen &pen )
+{
+  if( vertices.empty() )
+    return;
+  applyPen( pen );
+  glEnableClientState( GL_VERTEX_ARRAY );
+  glVertexPointer( 2, GL_FLOAT, 0, vertices.data() );
+  glDrawArrays( GL_TRIANGLES, 0, (GLsizei)( vertices.size() / 2 ) );
+  glDisableClientState( GL_VERTEX_ARRAY );
+  restorePen( pen );
+}
+
+void CGLRenderer::drawText( const TVector<2> &position, const string &text, const TPen &pen )
+{
+  applyPen( pen );
+  auto x = position[ 0 ],
+          y = position[ 1 ];
+
+  void *font = GLUT_BITMAP_TIMES_ROMAN_24;
+
+  double textWidth =
+          (double)( glutBitmapLength( font,
+                                      reinterpret_cast<const unsigned char *>(text.c_str()) )
+                    + text.size() - 1 ) / m_scale;
+  x -= textWidth / 2;
+
+  for( const auto &c: text )
+  {
+    glRasterPos2d( x, y );
+    glutBitmapCharacter( font, c );
+    x += ( glutBitmapWidth( font, c ) + 1 ) / m_scale;
+  }
+  restorePen( pen );
+}
+
+void CGLRenderer::present()
+{
+  glutSwapBuffers();
+}
+
+void CGLRenderer::applyPen( const TPen &pen )
+{
+  if( pen.depth != 0 )
+    glTranslated( 0, 0, pen.depth );
+  glColor4d( pen.r, pen.g, pen.b, pen.a );
+}
+
+void CGLRenderer::restorePen( const TPen &pen )
+{
+  if( pen.depth != 0 )
+    glTranslated( 0, 0, -pen.depth );
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "renderer.hpp"
+#include <GL/freeglut.h>
+
+/**
+ * Renderer drawing to glut window by openGL.
+ * Window and openGL context must exist.
+ */
+class CGLRenderer : public CRenderer
+{
+public:
+  void setView( const TVector<2> &viewOrigin, const TVector<2> &viewExtreme,
+                const TVector<2> &viewportOrigin, double scale ) override;
+
+  void clear() override;
+
+  void drawTriangles( const std::vector<float> &vertices, const TPen &pen ) override;
+
+  void drawText( const TVector<2> &position, const std::string &text, const TPen &pen ) override;
+
+  /**
+   * Swaps buffers of window.
+   */
+  void present() override;
+
+private:
+  /**
+   * Sets color and translation of pen.
+   * @param pen
+   */
+  static void applyPen( const TPen &pen );
+
+  /**
+   * Restores translation done by applyPen.
+   * @param pen
+   */
+  static void restorePen( const TPen &pen );
+
+  /**
+   * Pixels per scene unit.
+   */
+  double m_scale = 1;
+};
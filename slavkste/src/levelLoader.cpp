@@ -1,4 +1,6 @@
 #include "levelLoader.hpp"
+#include <fstream>
+#include <set>
 
 
 using namespace std;
@@ -64,6 +66,39 @@ void CLevelLoader::loadLevel( EActionType action )
   }
 }
 
+const string &CLevelLoader::levelFileName() const
+{
+  return m_currentLevelFileName;
+}
+
+uint64_t CLevelLoader::levelHash( const string &levelFileName )
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  set<string> visited;
+  // last level usually follows itself
+  for( string fileName = levelFileName; !fileName.empty() && visited.insert( fileName ).second; )
+  {
+    ifstream file( fileName, ios::binary );
+    if( !file )
+      throw invalid_argument( "Can not open level file " + fileName + ".\n" );
+    for( char byte; file.get( byte ); )
+    {
+      hash ^= (unsigned char)byte;
+      hash *= 0x100000001b3;
+    }
+
+    CJsonDocument json( fileName );
+    fileName = "";
+    if( json.m_type == EJsonType::jsonObjectType && json.get().count( "scene" ) )
+    {
+      const auto &scene = json.get()[ "scene" ].getObject();
+      if( scene.count( "next" ) )
+        fileName = scene[ "next" ].toString();
+    }
+  }
+  return hash;
+}
+
 void CLevelLoader::loadScene( const CJsonObject &sceneDescription )
 {
   loadTitle( sceneDescription );
@@ -134,14 +169,56 @@ void CLevelLoader::loadFields( const CJsonArray &fieldsDescription )
 void CLevelLoader::loadField( const CJsonValue &fieldDescription )
 {
   if( fieldDescription.m_type == EJsonType::jsonStringType )
+  {
     if( fieldDescription.toString() == "gravity" )
       m_engine.addField( CForceField::gravitationalField() );
+    return;
+  }
+
+  try
+  {
+    const auto &description = fieldDescription.getObject();
+    string fieldType = description[ "type" ].toString();
+    if( fieldType == "uniform" )
+      m_engine.addField( CForceField::uniformField( loadVector2D( description[ "acceleration" ].getArray() ) ) );
+    else if( fieldType == "radial" )
+    {
+      double radius = description.count( "radius" ) ? description[ "radius" ].toDouble() : HUGE_VAL;
+      if( radius <= 0 )
+        throw invalid_argument( "Radial field radius must be positive.\n" );
+      m_engine.addField( CForceField::radialField( loadVector2D( description[ "centre" ].getArray() ),
+                                                   description[ "strength" ].toDouble(), radius ) );
+    }
+    else if( fieldType == "drag" )
+      m_engine.addField( CForceField::dragField( description[ "coefficient" ].toDouble() ) );
+    else if( fieldType == "wind" )
+    {
+      TVector<2> min = loadVector2D( description[ "min" ].getArray() );
+      TVector<2> max = loadVector2D( description[ "max" ].getArray() );
+      if( min[ 0 ] > max[ 0 ] || min[ 1 ] > max[ 1 ] )
+        throw invalid_argument( "Wind region min must not be above max.\n" );
+      m_engine.addField( CForceField::windField( min, max, loadVector2D( description[ "velocity" ].getArray() ),
+                                                 description[ "coefficient" ].toDouble() ) );
+    }
+    else
+      throw invalid_argument( "Unknown field type " + fieldType + ".\n" );
+  }
+  catch( const out_of_range & )
+  {
+    throw invalid_argument( "Field is missing type or parameter.\n" );
+  }
+  catch( const bad_cast & )
+  {
+    throw invalid_argument( "Field must be a string or an object with vector parameters as arrays.\n" );
+  }
 }
 
 void CLevelLoader::loadPenAttributes( const CJsonObject &sceneDescription )
 {
   m_painter.drawWidth = 8;
   m_painter.density = 50;
+  m_painter.continuous = false;
+  m_painter.simplification = 0.25;
   if( !sceneDescription.count( "pen" ) )
     return;
 
@@ -154,6 +231,15 @@ void CLevelLoader::loadPenAttributes( const CJsonObject &sceneDescription )
     if( penDescription.count( "width" ) )
       m_painter.drawWidth = penDescription[ "width" ].toDouble();
 
+    if( penDescription.count( "continuous" ) )
+      m_painter.continuous = (bool)penDescription[ "continuous" ];
+
+    if( penDescription.count( "simplification" ) )
+      m_painter.simplification = penDescription[ "simplification" ].toDouble();
+
+    if( m_painter.simplification < 0 )
+      throw invalid_argument( "Stroke simplification must not be negative.\n" );
+
     if( m_painter.density <= 0 )
       throw invalid_argument( "Draw density must be positive.\n" );
 
@@ -267,6 +353,7 @@ void CLevelLoader::loadCircle( const CJsonObject &circleDescription,
     TVector<2> position = loadVector2D( circleDescription[ "position" ].getArray() );
     CPhysicsObject *newObj = new CCircle( position, radius, density );
     newObj->addTag( tags );
+    newObj->m_continuous = loadContinuous( circleDescription );
     m_objects.push_back( newObj );
   }
   catch( const out_of_range & )
@@ -335,6 +422,13 @@ double CLevelLoader::loadDensity( const CJsonObject &itemDescription )
   return density;
 }
 
+bool CLevelLoader::loadContinuous( const CJsonObject &itemDescription )
+{
+  if( !itemDescription.count( "physics" ) || !itemDescription[ "physics" ].count( "continuous" ) )
+    return false;
+  return (bool)itemDescription[ "physics" ][ "continuous" ];
+}
+
 double CLevelLoader::loadRotation( const CJsonObject &itemDescription )
 {
   if( itemDescription.count( "rotation" ) )
@@ -48,6 +48,19 @@ public:
    */
   void loadLevel( EActionType action = EActionType::resetLevel );
 
+  /**
+   * @return Name of current level file.
+   */
+  [[nodiscard]] const std::string &levelFileName() const;
+
+  /**
+   * Hash of contents of level file and of all levels following it.
+   * @param levelFileName first level
+   * @return Content hash, equal hashes mean same levels.
+   * @throws std::invalid_argument if some level file can not be read.
+   */
+  static uint64_t levelHash( const std::string &levelFileName );
+
   /**
    * Show if health-bar should be displayed.
    */
@@ -197,6 +210,13 @@ private:
    */
   static double loadDensity( const CJsonObject &itemDescription );
 
+  /**
+   * Loads continuous collision flag of item.
+   * @param itemDescription
+   * @return True if item is swept against rectangles.
+   */
+  static bool loadContinuous( const CJsonObject &itemDescription );
+
   /**
    * Loads item rotation
    * @param itemDescription
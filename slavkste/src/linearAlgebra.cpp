@@ -14,9 +14,9 @@ bool equalDoubles( double a, double b, double precision )
  * @return Vector rotated by angle. ( Counter clockwise )
  */
 template <>
-TVector<2, double> TVector<2, double>::rotated( double angle ) const
+TVector<2, TScalar> TVector<2, TScalar>::rotated( TScalar angle ) const
 {
-  return TMatrix<2, 2, double>::rotationMatrix2D( angle ) * *this;
+  return TMatrix<2, 2, TScalar>::rotationMatrix2D( angle ) * *this;
 }
 
 /**
@@ -26,7 +26,7 @@ TVector<2, double> TVector<2, double>::rotated( double angle ) const
  * @return *this
  */
 template <>
-TVector<2, double> &TVector<2, double>::rotate( double angle )
+TVector<2, TScalar> &TVector<2, TScalar>::rotate( TScalar angle )
 {
   return *this = this->rotated( angle );
 }
@@ -36,7 +36,7 @@ TVector<2, double> &TVector<2, double>::rotate( double angle )
  * @return Clockwise distance from canonical vector.
  */
 template <>
-double TVector<2, double>::getAngle() const
+TScalar TVector<2, TScalar>::getAngle() const
 {
   return -atan2( data[ 1 ], data[ 0 ] );
 }
@@ -46,7 +46,7 @@ double TVector<2, double>::getAngle() const
  * @return Matrix determinant.
  */
 template <>
-double TMatrix<2, 2, double>::det() const
+TScalar TMatrix<2, 2, TScalar>::det() const
 {
   return data[ 0 ][ 0 ] * data[ 1 ][ 1 ] - data[ 0 ][ 1 ] * data[ 1 ][ 0 ];
 }
@@ -56,9 +56,9 @@ double TMatrix<2, 2, double>::det() const
  * @return false if matrix not regular
  */
 template <>
-bool TMatrix<2, 2, double>::invert()
+bool TMatrix<2, 2, TScalar>::invert()
 {
-  double deter = det();
+  TScalar deter = det();
   if( equalDoubles( deter, 0 ) )
     return false;
   std::swap( data[ 0 ][ 0 ], data[ 1 ][ 1 ] );
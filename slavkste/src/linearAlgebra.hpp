@@ -7,11 +7,32 @@
 #include <cstdarg>
 #include <numeric>
 #include <ostream>
+#include <type_traits>
 
-template <size_t dim, typename dataType>
+/**
+ * Scalar type of physics.
+ * Define PHYSICS_FLOAT to build physics in single precision.
+ */
+#ifdef PHYSICS_FLOAT
+using TScalar = float;
+#else
+using TScalar = double;
+#endif
+
+/**
+ * Type of scalar parameters of vector operators.
+ * Scalar type is not deduced from them, so double constants can be used with float vectors.
+ */
+template <typename dataType>
+struct TScalarParam
+{
+  using type = dataType;
+};
+
+template <size_t dim, typename dataType = TScalar>
 struct TVector;
 
-template <size_t h, size_t w, typename dataType>
+template <size_t h, size_t w, typename dataType = TScalar>
 struct TMatrix;
 
 /**
@@ -44,7 +65,7 @@ inline TVector<fDim, fDataType> operator-( TVector<fDim, fDataType> lhs,
  * @return rhs multiplied by lhs
  */
 template <size_t fDim, typename fDataType>
-inline TVector<fDim, fDataType> operator*( fDataType lhs, TVector<fDim, fDataType> rhs );
+inline TVector<fDim, fDataType> operator*( typename TScalarParam<fDataType>::type lhs, TVector<fDim, fDataType> rhs );
 
 /**
  * @tparam fDim vector dimension
@@ -54,7 +75,7 @@ inline TVector<fDim, fDataType> operator*( fDataType lhs, TVector<fDim, fDataTyp
  * @return lhs multiplied by rhs;
  */
 template <size_t fDim, typename fDataType>
-inline TVector<fDim, fDataType> operator*( TVector<fDim, fDataType> lhs, fDataType rhs );
+inline TVector<fDim, fDataType> operator*( TVector<fDim, fDataType> lhs, typename TScalarParam<fDataType>::type rhs );
 
 /**
  * @tparam fDim vector dimension
@@ -64,17 +85,7 @@ inline TVector<fDim, fDataType> operator*( TVector<fDim, fDataType> lhs, fDataTy
  * @return lhs divided by rhs
  */
 template <size_t fDim, typename fDataType>
-inline TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, fDataType rhs );
-
-/**
- * @tparam fDim vector dimension
- * @tparam fDataType vector dataType
- * @param lhs
- * @param rhs
- * @return lhs divided by rhs
- */
-template <size_t fDim, typename fDataType>
-inline TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, int rhs );
+inline TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, typename TScalarParam<fDataType>::type rhs );
 
 /**
  *
@@ -98,7 +109,7 @@ inline TVector<h, dataType> operator*( const TMatrix<h, w, dataType> &lhs, const
  * @return matrix divided by num
  */
 template <size_t h, size_t w, typename dataType>
-inline TMatrix<h, w, dataType> operator/( TMatrix<h, w, dataType> mat, dataType num );
+inline TMatrix<h, w, dataType> operator/( TMatrix<h, w, dataType> mat, typename TScalarParam<dataType>::type num );
 
 /**
  * Compares double with precision of precision * epsilon.
@@ -130,7 +141,7 @@ inline std::ostream &operator<<( std::ostream &os, const TVector<dim, dataType>
  * @tparam dim vector dimension
  * @tparam dataType dataType of base field
  */
-template <size_t dim, typename dataType = double>
+template <size_t dim, typename dataType>
 struct TVector
 {
   /**
@@ -144,10 +155,13 @@ struct TVector
   TVector();
 
   /**
-   * Vector initialised from list.
-   * @param initList
+   * Vector initialised from dim values, which are converted to dataType.
+   * @param values
    */
-  TVector( std::initializer_list<dataType> initList );
+  template <typename... values_t,
+            typename = std::enable_if_t<sizeof...( values_t ) == dim &&
+                                        ( std::is_arithmetic_v<values_t> && ... )>>
+  TVector( values_t... values );
 
   /**
    * vector initialised from array.
@@ -249,13 +263,13 @@ struct TVector
    * @param angle
    * @return *this
    */
-  TVector<dim, dataType> &rotate( double angle );
+  TVector<dim, dataType> &rotate( dataType angle );
 
   /**
    * @param angle
    * @return Vector rotated by angle. ( Counter clockwise )
    */
-  [[nodiscard]] TVector<dim, dataType> rotated( double angle ) const;
+  [[nodiscard]] TVector<dim, dataType> rotated( dataType angle ) const;
 
   /**
    * Makes vector orthogonal to other,
@@ -313,7 +327,7 @@ struct TVector
   /**
    * @return Clockwise distance from canonical vector.
    */
-  [[nodiscard]] double getAngle() const;
+  [[nodiscard]] dataType getAngle() const;
 };
 
 /**
@@ -322,7 +336,7 @@ struct TVector
  * @tparam w dimension of rows
  * @tparam dataType dataType of base field
  */
-template <size_t h, size_t w, typename dataType = double>
+template <size_t h, size_t w, typename dataType>
 struct TMatrix
 {
   /**
@@ -340,7 +354,7 @@ struct TMatrix
    * @param angle
    * @return Rotation matrix.
    */
-  inline static TMatrix<2, 2, double> rotationMatrix2D( double angle );
+  inline static TMatrix<2, 2, dataType> rotationMatrix2D( dataType angle );
 
   /**
    * Divides matrix by num.
@@ -383,12 +397,9 @@ TVector<dim, dataType>::TVector()
 }
 
 template <size_t dim, typename dataType>
-TVector<dim, dataType>::TVector( std::initializer_list<dataType> initList )
-{
-  auto it = initList.begin();
-  for( size_t idx = 0; idx < dim; ++idx, ++it )
-    data[ idx ] = *it;
-}
+template <typename... values_t, typename>
+TVector<dim, dataType>::TVector( values_t... values )
+        : data{ static_cast<dataType>( values )... }{}
 
 template <size_t dim, typename dataType>
 TVector<dim, dataType>::TVector( std::array<dataType, dim> arr )
@@ -558,10 +569,10 @@ TMatrix<h, w, dataType>::TMatrix( std::initializer_list<TVector<h, dataType>> in
 }
 
 template <size_t h, size_t w, typename dataType>
-TMatrix<2, 2, double> TMatrix<h, w, dataType>::rotationMatrix2D( double angle )
+TMatrix<2, 2, dataType> TMatrix<h, w, dataType>::rotationMatrix2D( dataType angle )
 {
-  return { TVector<2>{ std::cos( angle ), -std::sin( angle ) },
-           TVector<2>{ std::sin( angle ), std::cos( angle ) } };
+  return { TVector<2, dataType>{ std::cos( angle ), -std::sin( angle ) },
+           TVector<2, dataType>{ std::sin( angle ), std::cos( angle ) } };
 }
 
 template <size_t h, size_t w, typename dataType>
@@ -602,7 +613,7 @@ TVector<fDim, fDataType> operator-( TVector<fDim, fDataType> lhs,
 }
 
 template <size_t fDim, typename fDataType>
-TVector<fDim, fDataType> operator*( fDataType lhs, TVector<fDim, fDataType> rhs )
+TVector<fDim, fDataType> operator*( typename TScalarParam<fDataType>::type lhs, TVector<fDim, fDataType> rhs )
 {
   for( size_t idx = 0; idx < fDim; ++idx )
     rhs[ idx ] *= lhs;
@@ -610,21 +621,13 @@ TVector<fDim, fDataType> operator*( fDataType lhs, TVector<fDim, fDataType> rhs
 }
 
 template <size_t fDim, typename fDataType>
-TVector<fDim, fDataType> operator*( TVector<fDim, fDataType> lhs, fDataType rhs )
+TVector<fDim, fDataType> operator*( TVector<fDim, fDataType> lhs, typename TScalarParam<fDataType>::type rhs )
 {
   return rhs * lhs;
 }
 
 template <size_t fDim, typename fDataType>
-TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, fDataType rhs )
-{
-  for( size_t idx = 0; idx < fDim; ++idx )
-    lhs[ idx ] /= rhs;
-  return lhs;
-}
-
-template <size_t fDim, typename fDataType>
-TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, int rhs )
+TVector<fDim, fDataType> operator/( TVector<fDim, fDataType> lhs, typename TScalarParam<fDataType>::type rhs )
 {
   for( size_t idx = 0; idx < fDim; ++idx )
     lhs[ idx ] /= rhs;
@@ -642,9 +645,395 @@ TVector<h, dataType> operator*( const TMatrix<h, w, dataType> &lhs, const TVecto
 }
 
 template <size_t h, size_t w, typename dataType>
-TMatrix<h, w, dataType> operator/( TMatrix<h, w, dataType> mat, dataType num )
+TMatrix<h, w, dataType> operator/( TMatrix<h, w, dataType> mat, typename TScalarParam<dataType>::type num )
 {
   for( size_t idx = 0; idx < w; ++idx )
     mat.data[ idx ] /= num;
   return mat;
 }
+
+/**
+ * @param centre
+ * @param first
+ * @param second
+ * @return Matrix of points centre + first, centre + second, centre - first, centre - second.
+ */
+template <typename dataType>
+inline TMatrix<2, 4, dataType> parallelogram( const TVector<2, dataType> &centre,
+                                              const TVector<2, dataType> &first,
+                                              const TVector<2, dataType> &second )
+{
+  return { centre + first, centre + second, centre - first, centre - second };
+}
+
+
+/*
+ * Specialisations of 2d and 4d double vectors and corner matrices for hot paths of physics.
+ * Kernels compute in place and in same order as generic templates, so results are bit-identical
+ * as long as compiler does not contract generic code to FMA ( -ffp-contract=off, see Makefile NATIVE ).
+ * Define LINEAR_ALGEBRA_GENERIC to compile generic templates only.
+ */
+#ifndef LINEAR_ALGEBRA_GENERIC
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#if defined( __AVX__ )
+#include <immintrin.h>
+#endif
+
+namespace kernels
+{
+#if defined( __SSE2__ )
+  inline void add2( double *lhs, const double *rhs )
+  {
+    _mm_storeu_pd( lhs, _mm_add_pd( _mm_loadu_pd( lhs ), _mm_loadu_pd( rhs ) ) );
+  }
+
+  inline void subtract2( double *lhs, const double *rhs )
+  {
+    _mm_storeu_pd( lhs, _mm_sub_pd( _mm_loadu_pd( lhs ), _mm_loadu_pd( rhs ) ) );
+  }
+
+  inline void multiply2( double *lhs, double rhs )
+  {
+    _mm_storeu_pd( lhs, _mm_mul_pd( _mm_loadu_pd( lhs ), _mm_set1_pd( rhs ) ) );
+  }
+
+  inline void divide2( double *lhs, double rhs )
+  {
+    _mm_storeu_pd( lhs, _mm_div_pd( _mm_loadu_pd( lhs ), _mm_set1_pd( rhs ) ) );
+  }
+
+  inline double dot2( const double *lhs, const double *rhs )
+  {
+    __m128d products = _mm_mul_pd( _mm_loadu_pd( lhs ), _mm_loadu_pd( rhs ) );
+    // generic loop starts from zero, -0 products sum to +0
+    __m128d sum = _mm_add_sd( _mm_setzero_pd(), products );
+    return _mm_cvtsd_f64( _mm_add_sd( sum, _mm_unpackhi_pd( products, products ) ) );
+  }
+
+  inline bool valid2( const double *vec )
+  {
+    __m128d values = _mm_loadu_pd( vec );
+    return _mm_movemask_pd( _mm_cmpunord_pd( values, values ) ) == 0;
+  }
+
+  inline void transform2( const double *first, const double *second, const double *vec, double *result )
+  {
+    __m128d sum = _mm_add_pd( _mm_setzero_pd(), _mm_mul_pd( _mm_loadu_pd( first ), _mm_set1_pd( vec[ 0 ] ) ) );
+    sum = _mm_add_pd( sum, _mm_mul_pd( _mm_loadu_pd( second ), _mm_set1_pd( vec[ 1 ] ) ) );
+    _mm_storeu_pd( result, sum );
+  }
+#else
+  inline void add2( double *lhs, const double *rhs )
+  {
+    lhs[ 0 ] += rhs[ 0 ];
+    lhs[ 1 ] += rhs[ 1 ];
+  }
+
+  inline void subtract2( double *lhs, const double *rhs )
+  {
+    lhs[ 0 ] -= rhs[ 0 ];
+    lhs[ 1 ] -= rhs[ 1 ];
+  }
+
+  inline void multiply2( double *lhs, double rhs )
+  {
+    lhs[ 0 ] *= rhs;
+    lhs[ 1 ] *= rhs;
+  }
+
+  inline void divide2( double *lhs, double rhs )
+  {
+    lhs[ 0 ] /= rhs;
+    lhs[ 1 ] /= rhs;
+  }
+
+  inline double dot2( const double *lhs, const double *rhs )
+  {
+    return 0. + lhs[ 0 ] * rhs[ 0 ] + lhs[ 1 ] * rhs[ 1 ];
+  }
+
+  inline bool valid2( const double *vec )
+  {
+    return vec[ 0 ] == vec[ 0 ] && vec[ 1 ] == vec[ 1 ];
+  }
+
+  inline void transform2( const double *first, const double *second, const double *vec, double *result )
+  {
+    double x = vec[ 0 ], y = vec[ 1 ];
+    result[ 0 ] = 0. + x * first[ 0 ] + y * second[ 0 ];
+    result[ 1 ] = 0. + x * first[ 1 ] + y * second[ 1 ];
+  }
+#endif
+
+#if defined( __AVX__ )
+  inline void add4( double *lhs, const double *rhs )
+  {
+    _mm256_storeu_pd( lhs, _mm256_add_pd( _mm256_loadu_pd( lhs ), _mm256_loadu_pd( rhs ) ) );
+  }
+
+  inline void subtract4( double *lhs, const double *rhs )
+  {
+    _mm256_storeu_pd( lhs, _mm256_sub_pd( _mm256_loadu_pd( lhs ), _mm256_loadu_pd( rhs ) ) );
+  }
+
+  inline void multiply4( double *lhs, double rhs )
+  {
+    _mm256_storeu_pd( lhs, _mm256_mul_pd( _mm256_loadu_pd( lhs ), _mm256_set1_pd( rhs ) ) );
+  }
+
+  inline void divide4( double *lhs, double rhs )
+  {
+    _mm256_storeu_pd( lhs, _mm256_div_pd( _mm256_loadu_pd( lhs ), _mm256_set1_pd( rhs ) ) );
+  }
+
+  inline double dot4( const double *lhs, const double *rhs )
+  {
+    alignas( 32 ) double products[ 4 ];
+    _mm256_store_pd( products, _mm256_mul_pd( _mm256_loadu_pd( lhs ), _mm256_loadu_pd( rhs ) ) );
+    return 0. + products[ 0 ] + products[ 1 ] + products[ 2 ] + products[ 3 ];
+  }
+
+  inline bool valid4( const double *vec )
+  {
+    __m256d values = _mm256_loadu_pd( vec );
+    return _mm256_movemask_pd( _mm256_cmp_pd( values, values, _CMP_UNORD_Q ) ) == 0;
+  }
+#else
+  inline void add4( double *lhs, const double *rhs )
+  {
+    add2( lhs, rhs );
+    add2( lhs + 2, rhs + 2 );
+  }
+
+  inline void subtract4( double *lhs, const double *rhs )
+  {
+    subtract2( lhs, rhs );
+    subtract2( lhs + 2, rhs + 2 );
+  }
+
+  inline void multiply4( double *lhs, double rhs )
+  {
+    multiply2( lhs, rhs );
+    multiply2( lhs + 2, rhs );
+  }
+
+  inline void divide4( double *lhs, double rhs )
+  {
+    divide2( lhs, rhs );
+    divide2( lhs + 2, rhs );
+  }
+
+  inline double dot4( const double *lhs, const double *rhs )
+  {
+    return 0. + lhs[ 0 ] * rhs[ 0 ] + lhs[ 1 ] * rhs[ 1 ] + lhs[ 2 ] * rhs[ 2 ] + lhs[ 3 ] * rhs[ 3 ];
+  }
+
+  inline bool valid4( const double *vec )
+  {
+    return valid2( vec ) && valid2( vec + 2 );
+  }
+#endif
+
+  inline void parallelogram( const double *centre, const double *first, const double *second,
+                             double *points[ 4 ] )
+  {
+#if defined( __AVX__ )
+    __m256d base = _mm256_broadcast_pd( (const __m128d *)centre );
+    __m256d offsets = _mm256_set_m128d( _mm_loadu_pd( second ), _mm_loadu_pd( first ) );
+    __m256d plus = _mm256_add_pd( base, offsets );
+    __m256d minus = _mm256_sub_pd( base, offsets );
+    _mm_storeu_pd( points[ 0 ], _mm256_castpd256_pd128( plus ) );
+    _mm_storeu_pd( points[ 1 ], _mm256_extractf128_pd( plus, 1 ) );
+    _mm_storeu_pd( points[ 2 ], _mm256_castpd256_pd128( minus ) );
+    _mm_storeu_pd( points[ 3 ], _mm256_extractf128_pd( minus, 1 ) );
+#else
+    for( size_t idx = 0; idx < 2; ++idx )
+    {
+      const double *offset = idx ? second : first;
+      points[ idx ][ 0 ] = centre[ 0 ];
+      points[ idx ][ 1 ] = centre[ 1 ];
+      points[ idx + 2 ][ 0 ] = centre[ 0 ];
+      points[ idx + 2 ][ 1 ] = centre[ 1 ];
+      add2( points[ idx ], offset );
+      subtract2( points[ idx + 2 ], offset );
+    }
+#endif
+  }
+}
+
+template <>
+inline TVector<2, double> &TVector<2, double>::operator+=( const TVector<2, double> &rhs )
+{
+  kernels::add2( data.data(), rhs.data.data() );
+  return *this;
+}
+
+template <>
+inline TVector<2, double> &TVector<2, double>::operator-=( const TVector<2, double> &rhs )
+{
+  kernels::subtract2( data.data(), rhs.data.data() );
+  return *this;
+}
+
+template <>
+inline TVector<2, double> &TVector<2, double>::operator*=( double rhs )
+{
+  kernels::multiply2( data.data(), rhs );
+  return *this;
+}
+
+template <>
+inline TVector<2, double> &TVector<2, double>::operator/=( double rhs )
+{
+  kernels::divide2( data.data(), rhs );
+  return *this;
+}
+
+template <>
+inline TVector<2, double>::operator bool() const
+{
+  return kernels::valid2( data.data() );
+}
+
+template <>
+inline double TVector<2, double>::squareNorm() const
+{
+  return kernels::dot2( data.data(), data.data() );
+}
+
+template <>
+inline double TVector<2, double>::dot( const TVector<2, double> &other ) const
+{
+  return kernels::dot2( data.data(), other.data.data() );
+}
+
+template <>
+inline TVector<4, double> &TVector<4, double>::operator+=( const TVector<4, double> &rhs )
+{
+  kernels::add4( data.data(), rhs.data.data() );
+  return *this;
+}
+
+template <>
+inline TVector<4, double> &TVector<4, double>::operator-=( const TVector<4, double> &rhs )
+{
+  kernels::subtract4( data.data(), rhs.data.data() );
+  return *this;
+}
+
+template <>
+inline TVector<4, double> &TVector<4, double>::operator*=( double rhs )
+{
+  kernels::multiply4( data.data(), rhs );
+  return *this;
+}
+
+template <>
+inline TVector<4, double> &TVector<4, double>::operator/=( double rhs )
+{
+  kernels::divide4( data.data(), rhs );
+  return *this;
+}
+
+template <>
+inline TVector<4, double>::operator bool() const
+{
+  return kernels::valid4( data.data() );
+}
+
+template <>
+inline double TVector<4, double>::squareNorm() const
+{
+  return kernels::dot4( data.data(), data.data() );
+}
+
+template <>
+inline double TVector<4, double>::dot( const TVector<4, double> &other ) const
+{
+  return kernels::dot4( data.data(), other.data.data() );
+}
+
+template <>
+inline TVector<2, double> operator+( TVector<2, double> lhs, const TVector<2, double> &rhs )
+{
+  return lhs += rhs;
+}
+
+template <>
+inline TVector<2, double> operator-( TVector<2, double> lhs, const TVector<2, double> &rhs )
+{
+  return lhs -= rhs;
+}
+
+template <>
+inline TVector<2, double> operator*( double lhs, TVector<2, double> rhs )
+{
+  return rhs *= lhs;
+}
+
+template <>
+inline TVector<2, double> operator*( TVector<2, double> lhs, double rhs )
+{
+  return lhs *= rhs;
+}
+
+template <>
+inline TVector<2, double> operator/( TVector<2, double> lhs, double rhs )
+{
+  return lhs /= rhs;
+}
+
+template <>
+inline TVector<4, double> operator+( TVector<4, double> lhs, const TVector<4, double> &rhs )
+{
+  return lhs += rhs;
+}
+
+template <>
+inline TVector<4, double> operator-( TVector<4, double> lhs, const TVector<4, double> &rhs )
+{
+  return lhs -= rhs;
+}
+
+template <>
+inline TVector<4, double> operator*( double lhs, TVector<4, double> rhs )
+{
+  return rhs *= lhs;
+}
+
+template <>
+inline TVector<4, double> operator*( TVector<4, double> lhs, double rhs )
+{
+  return lhs *= rhs;
+}
+
+template <>
+inline TVector<4, double> operator/( TVector<4, double> lhs, double rhs )
+{
+  return lhs /= rhs;
+}
+
+template <>
+inline TVector<2, double> operator*( const TMatrix<2, 2, double> &lhs, const TVector<2, double> &rhs )
+{
+  TVector<2, double> result;
+  kernels::transform2( lhs[ 0 ].data.data(), lhs[ 1 ].data.data(), rhs.data.data(), result.data.data() );
+  return result;
+}
+
+template <>
+inline TMatrix<2, 4, double> parallelogram( const TVector<2, double> &centre,
+                                            const TVector<2, double> &first,
+                                            const TVector<2, double> &second )
+{
+  TMatrix<2, 4, double> points{ {}, {}, {}, {} };
+  double *columns[ 4 ] = { points[ 0 ].data.data(), points[ 1 ].data.data(),
+                           points[ 2 ].data.data(), points[ 3 ].data.data() };
+  kernels::parallelogram( centre.data.data(), first.data.data(), second.data.data(), columns );
+  return points;
+}
+
+#endif
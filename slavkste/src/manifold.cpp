@@ -17,7 +17,7 @@ TManifold::TManifold( CPhysicsObject *first,
 
 TManifold::TManifold( CPhysicsObject *first_i,
                       CPhysicsObject *second_i,
-                      std::vector<TContactPoint> allContacts )
+                      TFrameVector<TContactPoint> allContacts )
   : first( first_i ),
     second( second_i ),
     contacts( move( allContacts ) )
@@ -3,6 +3,7 @@
 #include <functional>
 #include <vector>
 #include "linearAlgebra.hpp"
+#include "frameArena.hpp"
 
 
 class CPhysicsObject;
@@ -23,11 +24,18 @@ struct TContactPoint
    * Centre point of contact.
    */
   TVector<2> contactPoint;
+
+  /**
+   * Identifies colliding parts ( faces, vertices ) of objects. Stays same
+   * while same parts are in contact, used to match contacts between frames.
+   */
+  size_t feature = 0;
 };
 
 
 /**
  * Structure for storing all necessary information for collision resolution.
+ * Contacts of manifolds found in physics step are allocated in frame arena of engine.
  */
 struct TManifold
 {
@@ -65,7 +73,7 @@ struct TManifold
    * @param contacts
    */
   TManifold( CPhysicsObject *first, CPhysicsObject *second,
-             std::vector<TContactPoint> contacts );
+             TFrameVector<TContactPoint> contacts );
 
   /**
    * @return true if manifold is valid
@@ -88,5 +96,10 @@ struct TManifold
   /**
    * Collision points.
    */
-  std::vector<TContactPoint> contacts;
+  TFrameVector<TContactPoint> contacts;
 };
+
+/**
+ * Collisions found in physics step. Valid until next step of engine.
+ */
+using TManifoldList = TFrameVector<TManifold>;
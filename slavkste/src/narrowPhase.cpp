@@ -0,0 +1,395 @@
+#include "narrowPhase.hpp"
+#include "shapeDispatch.hpp"
+#include "contactCache.hpp"
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+
+using namespace std;
+
+/*
+ * Lanes of scalars processed at once, twice as many in single precision build.
+ * Kernels use only exactly rounded operations in same order as scalar collision tests,
+ * so results are bit-identical if scalar tests are not contracted to FMA ( -ffp-contract=off,
+ * which Makefile adds to NATIVE build ).
+ */
+#if defined( __AVX__ ) || defined( __SSE2__ )
+#define NARROW_PHASE_LANES
+namespace
+{
+#if defined( PHYSICS_FLOAT ) && defined( __AVX__ )
+using TLanes = __m256;
+const size_t laneCount = 8;
+
+inline TLanes load( const TScalar *values ){ return _mm256_loadu_ps( values ); }
+inline void store( TScalar *values, TLanes lanes ){ _mm256_storeu_ps( values, lanes ); }
+inline TLanes broadcast( TScalar value ){ return _mm256_set1_ps( value ); }
+inline TLanes add( TLanes a, TLanes b ){ return _mm256_add_ps( a, b ); }
+inline TLanes sub( TLanes a, TLanes b ){ return _mm256_sub_ps( a, b ); }
+inline TLanes mul( TLanes a, TLanes b ){ return _mm256_mul_ps( a, b ); }
+inline TLanes div( TLanes a, TLanes b ){ return _mm256_div_ps( a, b ); }
+inline TLanes sqrt( TLanes a ){ return _mm256_sqrt_ps( a ); }
+inline TLanes lessEqual( TLanes a, TLanes b ){ return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+inline TLanes greaterEqual( TLanes a, TLanes b ){ return _mm256_cmp_ps( a, b, _CMP_GE_OQ ); }
+inline TLanes notGreaterEqual( TLanes a, TLanes b ){ return _mm256_cmp_ps( a, b, _CMP_NGE_UQ ); }
+inline TLanes select( TLanes mask, TLanes a, TLanes b ){ return _mm256_blendv_ps( b, a, mask ); }
+#elif defined( PHYSICS_FLOAT )
+using TLanes = __m128;
+const size_t laneCount = 4;
+
+inline TLanes load( const TScalar *values ){ return _mm_loadu_ps( values ); }
+inline void store( TScalar *values, TLanes lanes ){ _mm_storeu_ps( values, lanes ); }
+inline TLanes broadcast( TScalar value ){ return _mm_set1_ps( value ); }
+inline TLanes add( TLanes a, TLanes b ){ return _mm_add_ps( a, b ); }
+inline TLanes sub( TLanes a, TLanes b ){ return _mm_sub_ps( a, b ); }
+inline TLanes mul( TLanes a, TLanes b ){ return _mm_mul_ps( a, b ); }
+inline TLanes div( TLanes a, TLanes b ){ return _mm_div_ps( a, b ); }
+inline TLanes sqrt( TLanes a ){ return _mm_sqrt_ps( a ); }
+inline TLanes lessEqual( TLanes a, TLanes b ){ return _mm_cmple_ps( a, b ); }
+inline TLanes greaterEqual( TLanes a, TLanes b ){ return _mm_cmpge_ps( a, b ); }
+inline TLanes notGreaterEqual( TLanes a, TLanes b ){ return _mm_cmpnge_ps( a, b ); }
+inline TLanes select( TLanes mask, TLanes a, TLanes b )
+{
+  return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#elif defined( __AVX__ )
+using TLanes = __m256d;
+const size_t laneCount = 4;
+
+inline TLanes load( const TScalar *values ){ return _mm256_loadu_pd( values ); }
+inline void store( TScalar *values, TLanes lanes ){ _mm256_storeu_pd( values, lanes ); }
+inline TLanes broadcast( TScalar value ){ return _mm256_set1_pd( value ); }
+inline TLanes add( TLanes a, TLanes b ){ return _mm256_add_pd( a, b ); }
+inline TLanes sub( TLanes a, TLanes b ){ return _mm256_sub_pd( a, b ); }
+inline TLanes mul( TLanes a, TLanes b ){ return _mm256_mul_pd( a, b ); }
+inline TLanes div( TLanes a, TLanes b ){ return _mm256_div_pd( a, b ); }
+inline TLanes sqrt( TLanes a ){ return _mm256_sqrt_pd( a ); }
+inline TLanes lessEqual( TLanes a, TLanes b ){ return _mm256_cmp_pd( a, b, _CMP_LE_OQ ); }
+inline TLanes greaterEqual( TLanes a, TLanes b ){ return _mm256_cmp_pd( a, b, _CMP_GE_OQ ); }
+inline TLanes notGreaterEqual( TLanes a, TLanes b ){ return _mm256_cmp_pd( a, b, _CMP_NGE_UQ ); }
+inline TLanes select( TLanes mask, TLanes a, TLanes b ){ return _mm256_blendv_pd( b, a, mask ); }
+#else
+using TLanes = __m128d;
+const size_t laneCount = 2;
+
+inline TLanes load( const TScalar *values ){ return _mm_loadu_pd( values ); }
+inline void store( TScalar *values, TLanes lanes ){ _mm_storeu_pd( values, lanes ); }
+inline TLanes broadcast( TScalar value ){ return _mm_set1_pd( value ); }
+inline TLanes add( TLanes a, TLanes b ){ return _mm_add_pd( a, b ); }
+inline TLanes sub( TLanes a, TLanes b ){ return _mm_sub_pd( a, b ); }
+inline TLanes mul( TLanes a, TLanes b ){ return _mm_mul_pd( a, b ); }
+inline TLanes div( TLanes a, TLanes b ){ return _mm_div_pd( a, b ); }
+inline TLanes sqrt( TLanes a ){ return _mm_sqrt_pd( a ); }
+inline TLanes lessEqual( TLanes a, TLanes b ){ return _mm_cmple_pd( a, b ); }
+inline TLanes greaterEqual( TLanes a, TLanes b ){ return _mm_cmpge_pd( a, b ); }
+inline TLanes notGreaterEqual( TLanes a, TLanes b ){ return _mm_cmpnge_pd( a, b ); }
+inline TLanes select( TLanes mask, TLanes a, TLanes b )
+{
+  return _mm_or_pd( _mm_and_pd( mask, a ), _mm_andnot_pd( mask, b ) );
+}
+#endif
+
+/**
+ * @return Dot product of vectors ( x, y ), ( u, v ) in each lane, summed as TVector::dot.
+ */
+inline TLanes dot( TLanes x, TLanes y, TLanes u, TLanes v )
+{
+  return add( add( broadcast( 0 ), mul( x, u ) ), mul( y, v ) );
+}
+
+/**
+ * Writes contacts of lanes starting at contacts.
+ */
+inline void storeContacts( TLanes overlapX, TLanes overlapY, TLanes pointX, TLanes pointY,
+                           TContactPoint *contacts )
+{
+  TScalar values[ 4 ][ laneCount ];
+  store( values[ 0 ], overlapX );
+  store( values[ 1 ], overlapY );
+  store( values[ 2 ], pointX );
+  store( values[ 3 ], pointY );
+  for( size_t lane = 0; lane < laneCount; ++lane )
+    contacts[ lane ] = { { values[ 0 ][ lane ], values[ 1 ][ lane ] },
+                         { values[ 2 ][ lane ], values[ 3 ][ lane ] } };
+}
+}
+#endif
+
+
+void TCirclePairs::clear()
+{
+  for( auto values: { &firstX, &firstY, &firstRadius, &secondX, &secondY, &secondRadius } )
+    values->clear();
+}
+
+void TCirclePairs::push( const TVector<2> &firstCentre, TScalar firstRadius_,
+                         const TVector<2> &secondCentre, TScalar secondRadius_ )
+{
+  firstX.push_back( firstCentre[ 0 ] );
+  firstY.push_back( firstCentre[ 1 ] );
+  firstRadius.push_back( firstRadius_ );
+  secondX.push_back( secondCentre[ 0 ] );
+  secondY.push_back( secondCentre[ 1 ] );
+  secondRadius.push_back( secondRadius_ );
+}
+
+size_t TCirclePairs::size() const
+{
+  return firstX.size();
+}
+
+void TRectCirclePairs::clear()
+{
+  for( size_t idx = 0; idx < 4; ++idx )
+  {
+    cornerX[ idx ].clear();
+    cornerY[ idx ].clear();
+  }
+  centreX.clear();
+  centreY.clear();
+  radius.clear();
+}
+
+void TRectCirclePairs::push( const TMatrix<2, 4> &corners, const TVector<2> &centre, TScalar radius_ )
+{
+  for( size_t idx = 0; idx < 4; ++idx )
+  {
+    cornerX[ idx ].push_back( corners[ idx ][ 0 ] );
+    cornerY[ idx ].push_back( corners[ idx ][ 1 ] );
+  }
+  centreX.push_back( centre[ 0 ] );
+  centreY.push_back( centre[ 1 ] );
+  radius.push_back( radius_ );
+}
+
+size_t TRectCirclePairs::size() const
+{
+  return centreX.size();
+}
+
+void TRectPairs::clear()
+{
+  for( auto values: { &firstX, &firstY, &secondX, &secondY } )
+    values->clear();
+  firstShape.clear();
+  secondShape.clear();
+}
+
+void TRectPairs::push( const TVector<2> &firstPos, const TRectangleShape &firstShape_,
+                       const TVector<2> &secondPos, const TRectangleShape &secondShape_ )
+{
+  firstX.push_back( firstPos[ 0 ] );
+  firstY.push_back( firstPos[ 1 ] );
+  firstShape.push_back( firstShape_ );
+  secondX.push_back( secondPos[ 0 ] );
+  secondY.push_back( secondPos[ 1 ] );
+  secondShape.push_back( secondShape_ );
+}
+
+size_t TRectPairs::size() const
+{
+  return firstX.size();
+}
+
+
+void collision::circleCircle( const TCirclePairs &pairs, TContactPoint *contacts )
+{
+  size_t idx = 0;
+#ifdef NARROW_PHASE_LANES
+  for( ; idx + laneCount <= pairs.size(); idx += laneCount )
+  {
+    TLanes firstX = load( &pairs.firstX[ idx ] ), firstY = load( &pairs.firstY[ idx ] );
+    TLanes firstRadius = load( &pairs.firstRadius[ idx ] );
+    TLanes relativeX = sub( load( &pairs.secondX[ idx ] ), firstX );
+    TLanes relativeY = sub( load( &pairs.secondY[ idx ] ), firstY );
+    TLanes distance = sqrt( dot( relativeX, relativeY, relativeX, relativeY ) );
+    TLanes overlapSize = sub( add( firstRadius, load( &pairs.secondRadius[ idx ] ) ), distance );
+
+    TLanes halfOverlap = div( overlapSize, broadcast( 2 ) );
+    TLanes overlapX = div( mul( relativeX, halfOverlap ), distance );
+    TLanes overlapY = div( mul( relativeY, halfOverlap ), distance );
+    TLanes pointX = sub( add( firstX, div( mul( relativeX, firstRadius ), distance ) ), overlapX );
+    TLanes pointY = sub( add( firstY, div( mul( relativeY, firstRadius ), distance ) ), overlapY );
+
+    TLanes separated = lessEqual( overlapSize, broadcast( 0 ) );
+    storeContacts( select( separated, broadcast( 0 ), overlapX ),
+                   select( separated, broadcast( 0 ), overlapY ),
+                   select( separated, broadcast( NAN ), pointX ),
+                   select( separated, broadcast( NAN ), pointY ),
+                   contacts + idx );
+  }
+#endif
+  for( ; idx < pairs.size(); ++idx )
+    contacts[ idx ] = circleCircle( { pairs.firstX[ idx ], pairs.firstY[ idx ] }, pairs.firstRadius[ idx ],
+                                    { pairs.secondX[ idx ], pairs.secondY[ idx ] }, pairs.secondRadius[ idx ] );
+}
+
+void collision::rectCircle( const TRectCirclePairs &pairs, TContactPoint *contacts )
+{
+  size_t idx = 0;
+#ifdef NARROW_PHASE_LANES
+  for( ; idx + laneCount <= pairs.size(); idx += laneCount )
+  {
+    TLanes centreX = load( &pairs.centreX[ idx ] ), centreY = load( &pairs.centreY[ idx ] );
+    TLanes smallestDist = broadcast( HUGE_VAL );
+    TLanes closestX = broadcast( 0 ), closestY = broadcast( 0 );
+    for( size_t edge = 0; edge < 4; ++edge )
+    {
+      // closest point of edge to centre, as lineSegmentClosestPoint
+      TLanes beginX = load( &pairs.cornerX[ edge ][ idx ] );
+      TLanes beginY = load( &pairs.cornerY[ edge ][ idx ] );
+      TLanes endX = load( &pairs.cornerX[ ( edge + 1 ) % 4 ][ idx ] );
+      TLanes endY = load( &pairs.cornerY[ ( edge + 1 ) % 4 ][ idx ] );
+      TLanes directionX = sub( endX, beginX ), directionY = sub( endY, beginY );
+      TLanes projectionScale = div( dot( directionX, directionY,
+                                         sub( centreX, beginX ), sub( centreY, beginY ) ),
+                                    dot( directionX, directionY, directionX, directionY ) );
+      TLanes beforeBegin = lessEqual( projectionScale, broadcast( 0 ) );
+      TLanes afterEnd = greaterEqual( projectionScale, broadcast( 1 ) );
+      TLanes pointX = add( beginX, mul( directionX, projectionScale ) );
+      TLanes pointY = add( beginY, mul( directionY, projectionScale ) );
+      pointX = select( beforeBegin, beginX, select( afterEnd, endX, pointX ) );
+      pointY = select( beforeBegin, beginY, select( afterEnd, endY, pointY ) );
+
+      TLanes offsetX = sub( pointX, centreX ), offsetY = sub( pointY, centreY );
+      TLanes newDist = dot( offsetX, offsetY, offsetX, offsetY );
+      TLanes closer = notGreaterEqual( newDist, smallestDist );
+      smallestDist = select( closer, newDist, smallestDist );
+      closestX = select( closer, pointX, closestX );
+      closestY = select( closer, pointY, closestY );
+    }
+
+    TLanes radius = load( &pairs.radius[ idx ] );
+    TLanes offsetX = sub( closestX, centreX ), offsetY = sub( closestY, centreY );
+    TLanes distance = sqrt( dot( offsetX, offsetY, offsetX, offsetY ) );
+    TLanes overlapX = sub( centreX, closestX ), overlapY = sub( centreY, closestY );
+    TLanes overlapNorm = sqrt( dot( overlapX, overlapY, overlapX, overlapY ) );
+    TLanes overlapSize = div( sub( radius, distance ), broadcast( 2 ) );
+    overlapX = div( mul( overlapX, overlapSize ), overlapNorm );
+    overlapY = div( mul( overlapY, overlapSize ), overlapNorm );
+
+    TLanes separated = greaterEqual( distance, radius );
+    storeContacts( select( separated, broadcast( 0 ), overlapX ),
+                   select( separated, broadcast( 0 ), overlapY ),
+                   select( separated, broadcast( NAN ), sub( closestX, overlapX ) ),
+                   select( separated, broadcast( NAN ), sub( closestY, overlapY ) ),
+                   contacts + idx );
+  }
+#endif
+  for( ; idx < pairs.size(); ++idx )
+    contacts[ idx ] = rectCircle( { { pairs.cornerX[ 0 ][ idx ], pairs.cornerY[ 0 ][ idx ] },
+                                    { pairs.cornerX[ 1 ][ idx ], pairs.cornerY[ 1 ][ idx ] },
+                                    { pairs.cornerX[ 2 ][ idx ], pairs.cornerY[ 2 ][ idx ] },
+                                    { pairs.cornerX[ 3 ][ idx ], pairs.cornerY[ 3 ][ idx ] } },
+                                  { pairs.centreX[ idx ], pairs.centreY[ idx ] }, pairs.radius[ idx ] );
+}
+
+void collision::rectRect( const TRectPairs &pairs, TContactPoint *contacts )
+{
+  for( size_t idx = 0; idx < pairs.size(); ++idx )
+    contacts[ idx ] = rectRect( { pairs.firstX[ idx ], pairs.firstY[ idx ] }, pairs.firstShape[ idx ],
+                                { pairs.secondX[ idx ], pairs.secondY[ idx ] }, pairs.secondShape[ idx ] );
+}
+
+
+void CNarrowPhase::findCollisions( const vector<CPhysicsObject *> &objects,
+                                   const vector<TCandidatePair> &pairs,
+                                   TManifoldList &collisions )
+{
+  using collision::shapePair;
+
+  m_circles.clear();
+  m_rectCircles.clear();
+  m_rectangles.clear();
+  reserveDoubling( m_slots, pairs.size() );
+  m_slots.resize( pairs.size() );
+  for( size_t idx = 0; idx < pairs.size(); ++idx )
+  {
+    auto [ a, b ] = pairs[ idx ];
+    auto &slot = m_slots[ idx ];
+    if( CContactCache::restingPair( *objects[ a ], *objects[ b ] ) )
+    {
+      slot.batch = TPairSlot::RESTING;
+      continue;
+    }
+
+    // order of objects in pair follows double dispatch of getManifold
+    size_t pairType = shapePair( objects[ a ]->m_shapeType, objects[ b ]->m_shapeType );
+    if( pairType == shapePair( EShapeType::RECTANGLE, EShapeType::CIRCLE ) )
+    {
+      swap( a, b );
+      pairType = shapePair( EShapeType::CIRCLE, EShapeType::RECTANGLE );
+    }
+    switch( pairType )
+    {
+      case shapePair( EShapeType::CIRCLE, EShapeType::CIRCLE ):
+      {
+        const auto &firstCircle = static_cast<const CCircle &>( *objects[ b ] );
+        const auto &secondCircle = static_cast<const CCircle &>( *objects[ a ] );
+        slot = { TPairSlot::CIRCLES, m_circles.size() };
+        m_circles.push( firstCircle.m_position, firstCircle.m_radius,
+                        secondCircle.m_position, secondCircle.m_radius );
+        break;
+      }
+      case shapePair( EShapeType::CIRCLE, EShapeType::RECTANGLE ):
+      {
+        const auto &rectangle = static_cast<const CRectangle &>( *objects[ b ] );
+        const auto &circle = static_cast<const CCircle &>( *objects[ a ] );
+        slot = { TPairSlot::RECT_CIRCLE, m_rectCircles.size() };
+        m_rectCircles.push( rectangle.corners(), circle.m_position, circle.m_radius );
+        break;
+      }
+      case shapePair( EShapeType::RECTANGLE, EShapeType::RECTANGLE ):
+      {
+        const auto &firstRectangle = static_cast<const CRectangle &>( *objects[ b ] );
+        const auto &secondRectangle = static_cast<const CRectangle &>( *objects[ a ] );
+        slot = { TPairSlot::RECTANGLES, m_rectangles.size() };
+        m_rectangles.push( firstRectangle.m_position, firstRectangle.m_shape,
+                           secondRectangle.m_position, secondRectangle.m_shape );
+        break;
+      }
+      default:
+        slot = { TPairSlot::SINGLE, pairType };
+    }
+  }
+
+  m_circleContacts.resize( m_circles.size() );
+  m_rectCircleContacts.resize( m_rectCircles.size() );
+  m_rectangleContacts.resize( m_rectangles.size() );
+  collision::circleCircle( m_circles, m_circleContacts.data() );
+  collision::rectCircle( m_rectCircles, m_rectCircleContacts.data() );
+  collision::rectRect( m_rectangles, m_rectangleContacts.data() );
+
+  for( size_t idx = 0; idx < pairs.size(); ++idx )
+  {
+    auto [ a, b ] = pairs[ idx ];
+    const auto &slot = m_slots[ idx ];
+    if( slot.batch == TPairSlot::RESTING )
+      continue;
+    if( slot.batch == TPairSlot::SINGLE )
+    {
+      TManifold collision = collision::manifoldFunctions[ slot.index ]( objects[ a ], objects[ b ] );
+      if( collision )
+        collisions.push_back( move( collision ) );
+      continue;
+    }
+
+    const TContactPoint *contact;
+    if( slot.batch == TPairSlot::CIRCLES )
+      contact = &m_circleContacts[ slot.index ];
+    else if( slot.batch == TPairSlot::RECT_CIRCLE )
+    {
+      contact = &m_rectCircleContacts[ slot.index ];
+      if( objects[ a ]->m_shapeType == EShapeType::RECTANGLE )
+        swap( a, b );
+    }
+    else
+      contact = &m_rectangleContacts[ slot.index ];
+    if( contact->contactPoint )
+      collisions.emplace_back( objects[ b ], objects[ a ], *contact );
+  }
+}
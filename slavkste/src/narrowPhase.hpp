@@ -0,0 +1,188 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include "broadPhase.hpp"
+#include <vector>
+
+
+/**
+ * Circle pairs in structure of arrays form.
+ */
+struct TCirclePairs
+{
+  /**
+   * Removes all pairs, keeps capacity.
+   */
+  void clear();
+
+  /**
+   * Adds pair of circles.
+   * @param firstCentre, secondCentre centre of circle
+   * @param firstRadius, secondRadius radius of circle
+   */
+  void push( const TVector<2> &firstCentre, TScalar firstRadius,
+             const TVector<2> &secondCentre, TScalar secondRadius );
+
+  /**
+   * @return Number of pairs.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * Centre and radius of first circle.
+   */
+  std::vector<TScalar> firstX, firstY, firstRadius;
+
+  /**
+   * Centre and radius of second circle.
+   */
+  std::vector<TScalar> secondX, secondY, secondRadius;
+};
+
+/**
+ * Rectangle and circle pairs in structure of arrays form.
+ * Rectangles are stored by their corners.
+ */
+struct TRectCirclePairs
+{
+  /**
+   * Removes all pairs, keeps capacity.
+   */
+  void clear();
+
+  /**
+   * Adds pair of rectangle and circle.
+   * @param corners corners of rectangle
+   * @param centre centre of circle
+   * @param radius circle radius
+   */
+  void push( const TMatrix<2, 4> &corners, const TVector<2> &centre, TScalar radius );
+
+  /**
+   * @return Number of pairs.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * Corners of rectangle from top-right clockwise.
+   */
+  std::vector<TScalar> cornerX[ 4 ], cornerY[ 4 ];
+
+  /**
+   * Centre and radius of circle.
+   */
+  std::vector<TScalar> centreX, centreY, radius;
+};
+
+/**
+ * Rectangle pairs in structure of arrays form.
+ */
+struct TRectPairs
+{
+  /**
+   * Removes all pairs, keeps capacity.
+   */
+  void clear();
+
+  /**
+   * Adds pair of rectangles.
+   * @param firstPos, secondPos centre of rectangle
+   * @param firstShape, secondShape rectangle shape
+   */
+  void push( const TVector<2> &firstPos, const TRectangleShape &firstShape,
+             const TVector<2> &secondPos, const TRectangleShape &secondShape );
+
+  /**
+   * @return Number of pairs.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * Centre of first and second rectangle.
+   */
+  std::vector<TScalar> firstX, firstY, secondX, secondY;
+
+  /**
+   * Shape of first and second rectangle.
+   */
+  std::vector<TRectangleShape> firstShape, secondShape;
+};
+
+namespace collision
+{
+
+/**
+ * Calculates collision information of each pair of circles, several pairs at once.
+ * Results are same as of circleCircle for each pair.
+ * @param pairs
+ * @param contacts preallocated storage for pairs.size() contacts
+ */
+void circleCircle( const TCirclePairs &pairs, TContactPoint *contacts );
+
+/**
+ * Calculates collision information of each pair of rectangle and circle, several pairs at once.
+ * Results are same as of rectCircle for each pair.
+ * @param pairs
+ * @param contacts preallocated storage for pairs.size() contacts
+ */
+void rectCircle( const TRectCirclePairs &pairs, TContactPoint *contacts );
+
+/**
+ * Calculates collision information of each pair of rectangles.
+ * Separating axis test exits early for most pairs, so pairs are tested one by one.
+ * @param pairs
+ * @param contacts preallocated storage for pairs.size() contacts
+ */
+void rectRect( const TRectPairs &pairs, TContactPoint *contacts );
+
+} // namespace collision
+
+/**
+ * Exact collision search over candidate pairs. Circles and rectangles are
+ * collected to batches and tested by batched kernels, other pairs use collision
+ * function of their shape pair type.
+ * Manifolds are same and in same order as if getManifold was called on each pair.
+ */
+class CNarrowPhase
+{
+public:
+  /**
+   * Tests candidate pairs, pairs resting in contact are skipped.
+   * @param objects
+   * @param pairs candidate pairs from broad-phase
+   * @param collisions storage for found collisions
+   */
+  void findCollisions( const std::vector<CPhysicsObject *> &objects,
+                       const std::vector<TCandidatePair> &pairs,
+                       TManifoldList &collisions );
+
+private:
+  /**
+   * Batch of candidate pair and index in it. Index of pair tested alone is its shape pair type.
+   */
+  struct TPairSlot
+  {
+    enum : char
+    {
+      RESTING, SINGLE, CIRCLES, RECT_CIRCLE, RECTANGLES
+    } batch;
+    size_t index;
+  };
+
+  /**
+   * Slot of each candidate pair.
+   */
+  std::vector<TPairSlot> m_slots;
+
+  /**
+   * Batches of pairs, reused between calls.
+   */
+  TCirclePairs m_circles;
+  TRectCirclePairs m_rectCircles;
+  TRectPairs m_rectangles;
+
+  /**
+   * Preallocated contacts of batches.
+   */
+  std::vector<TContactPoint> m_circleContacts, m_rectCircleContacts, m_rectangleContacts;
+};
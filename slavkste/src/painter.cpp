@@ -16,6 +16,9 @@ double CPainter::start( int x, int y, vector<CPhysicsObject *> &objects )
 {
   lastMousePosition = { (double)x, (double)y };
 
+  // objects do not move while drawing, scene is indexed once per stroke
+  m_rayCaster.build( objects );
+
   TVector<2> accumulatedShift;
 
   size_t rayCount = 8;
@@ -23,17 +26,14 @@ double CPainter::start( int x, int y, vector<CPhysicsObject *> &objects )
   {
     auto dir =
             TVector<2>::canonical( 0 ).rotated( 2 * M_PI * (double)idx / (double)rayCount );
-    for( auto object: objects )
+    for( const auto &hit: m_rayCaster.hits( { lastMousePosition, dir }, drawWidth ) )
     {
-      double rayLength = object->rayTrace( lastMousePosition, dir );
-      if( rayLength > drawWidth )
-        continue;
-      if( rayLength < drawWidth / 2 )
+      if( hit.distance < drawWidth / 2 )
       {
         reset();
         return 0;
       }
-      accumulatedShift -= dir * ( drawWidth - rayLength );
+      accumulatedShift -= dir * ( drawWidth - hit.distance );
     }
   }
 
@@ -63,7 +63,7 @@ double CPainter::addPoint( int x, int y, vector<CPhysicsObject *> &objects )
                     direction + 1.5 * normal,
                     direction - 1.5 * normal } )
   {
-    double len = addPoint( dir, objects );
+    double len = addPoint( dir );
     if( len != 0 )
     {
       redrawCallback();
@@ -90,7 +90,12 @@ void CPainter::stop()
 {
   if( !currentlyDrawn )
     return;
+  statistics.strokes++;
+  statistics.vertices += currentlyDrawn->vertexCount();
+  if( simplification > 0 )
+    statistics.removedVertices += currentlyDrawn->simplify( simplification * drawWidth );
   currentlyDrawn->spawn( density );
+  currentlyDrawn->m_continuous = continuous;
   reset();
 }
 
@@ -100,27 +105,27 @@ void CPainter::reset()
   currentlyDrawn = nullptr;
 }
 
-double CPainter::addPoint( const TVector<2> &direction, std::vector<CPhysicsObject *> &objects )
+double CPainter::addPoint( const TVector<2> &direction )
 {
   TVector<2> normal = crossProduct( direction ).stretchedTo( drawWidth * 0.8 );
 
   double maxMoveLength = direction.norm();
+  vector<TRay> rays;
   for( auto &startOffset: { normal + direction.stretchedTo( drawWidth ) * 0.2,
                             1.2 * direction.stretchedTo( drawWidth ),
                             -normal + direction.stretchedTo( drawWidth ) * 0.2 } )
+    rays.push_back( { lastMousePosition + startOffset, direction } );
+
+  // hits further than maxMoveLength never shorten the move
+  for( const auto &hit: m_rayCaster.nearest( rays, max( maxMoveLength - drawWidth * 0.2, 0. ),
+                                             currentlyDrawn ) )
   {
-    for( const auto &object: objects )
-    {
-      if( object == currentlyDrawn )
-        continue;
-      double moveLength = object->rayTrace( lastMousePosition + startOffset,
-                                            direction ) + drawWidth * 0.2;
-      if( moveLength >= maxMoveLength )
-        continue;
-      maxMoveLength = moveLength;
-      if( maxMoveLength < minDrawLength / 2 )
-        return 0;
-    }
+    double moveLength = hit.distance + drawWidth * 0.2;
+    if( moveLength >= maxMoveLength )
+      continue;
+    maxMoveLength = moveLength;
+    if( maxMoveLength < minDrawLength / 2 )
+      return 0;
   }
 
   lastMousePosition += direction.stretchedTo( maxMoveLength );
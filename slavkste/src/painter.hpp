@@ -4,6 +4,28 @@
 #include <vector>
 #include <functional>
 #include "physicsObject.hpp"
+#include "rayCaster.hpp"
+
+/**
+ * Statistics of stroke simplification.
+ */
+struct TStrokeStatistics
+{
+  /**
+   * Number of finished strokes.
+   */
+  size_t strokes = 0;
+
+  /**
+   * Number of vertices drawn in finished strokes.
+   */
+  size_t vertices = 0;
+
+  /**
+   * Number of vertices removed by simplification.
+   */
+  size_t removedVertices = 0;
+};
 
 /**
  * Class responsible for drawing complex objects to screen and ray-casting.
@@ -26,7 +48,7 @@ public:
   double addPoint( int x, int y, std::vector<CPhysicsObject *> &objects );
 
   /**
-   * Stop's drawing of object and assigns physics attributes to it.
+   * Stop's drawing of object, simplifies its line strip and assigns physics attributes to it.
    */
   void stop();
 
@@ -53,6 +75,21 @@ public:
    */
   double density = 50;
 
+  /**
+   * Drawn objects use continuous collision with rectangles.
+   */
+  bool continuous = false;
+
+  /**
+   * Tolerance of stroke simplification relative to draw width. 0 disables simplification.
+   */
+  double simplification = 0.25;
+
+  /**
+   * Statistics of all finished strokes.
+   */
+  TStrokeStatistics statistics;
+
   /**
    * Stops drawing without spawning object.
    */
@@ -71,12 +108,11 @@ private:
   /**
    * Tries to create new vertex in direction from lastMousePosition.
    * Drawn line has length between minDrawLen / 2 and minDrawLen.
+   * Blocking objects are those indexed by start.
    * @param direction direction of line
-   * @param objects vector of blocking objects / storage for drawn objects
    * @return Length of drawn line.
    */
-  double addPoint( const TVector<2> &direction,
-                   std::vector<CPhysicsObject *> &objects );
+  double addPoint( const TVector<2> &direction );
 
   /**
    * Object that is being currently drawn.
@@ -88,6 +124,11 @@ private:
    */
   TVector<2> lastMousePosition{ NAN, NAN };
 
+  /**
+   * Blocking objects indexed when drawing of object started.
+   */
+  CRayCaster m_rayCaster;
+
   /**
    * Callback for redrawing screen.
    */
@@ -3,42 +3,42 @@
 
 using namespace std;
 
-TPhysicsAttributes TPhysicsAttributes::rectangleAttributes( double density,
+TPhysicsAttributes TPhysicsAttributes::rectangleAttributes( TScalar density,
                                                             const TVector<2> &size )
 {
-  double mass = density * size[ 0 ] * size[ 1 ];
-  double angularMass = mass * ( size[ 0 ] * size[ 0 ] + size[ 1 ] * size[ 1 ] ) / 12;
+  TScalar mass = density * size[ 0 ] * size[ 1 ];
+  TScalar angularMass = mass * ( size[ 0 ] * size[ 0 ] + size[ 1 ] * size[ 1 ] ) / 12;
   return { mass, angularMass };
 }
 
-TPhysicsAttributes TPhysicsAttributes::circleAttributes( double density, double radius )
+TPhysicsAttributes TPhysicsAttributes::circleAttributes( TScalar density, TScalar radius )
 {
-  double mass = M_PI * radius * radius * density;
+  TScalar mass = M_PI * radius * radius * density;
   return { mass, mass * radius * radius / 2 };
 }
 
-TPhysicsAttributes TPhysicsAttributes::complexObjectAttributes( double width,
-                                                                double density,
+TPhysicsAttributes TPhysicsAttributes::complexObjectAttributes( TScalar width,
+                                                                TScalar density,
                                                                 vector<TVector<2>> points )
 {
   if( points.size() < 2 )
     return circleAttributes( density, width );
 
-  double mass = 0, segmentMass;
-  double angularMass = 0;
+  TScalar mass = 0, segmentMass;
+  TScalar angularMass = 0;
   for( auto it = points.begin() + 1; it != points.end(); ++it )
   {
     TVector<2> segmentDirection = *it - *( it - 1 );
     TVector<2> segmentCentre = ( *it + *( it - 1 ) ) / 2;
-    double segmentLength = segmentDirection.norm();
+    TScalar segmentLength = segmentDirection.norm();
     mass += segmentMass = segmentLength * density;
-    double localAngularMass = segmentMass * segmentDirection.squareNorm() / 12;
+    TScalar localAngularMass = segmentMass * segmentDirection.squareNorm() / 12;
     angularMass += localAngularMass + mass * segmentCentre.squareNorm();
   }
   return { mass, angularMass };
 }
 
-TPhysicsAttributes::TPhysicsAttributes( double mass, double angularMass )
+TPhysicsAttributes::TPhysicsAttributes( TScalar mass, TScalar angularMass )
         : mass( mass ),
           invMass( 1 / mass ),
           angularMass( angularMass / 2 ),
@@ -14,7 +14,7 @@ struct TPhysicsAttributes
    * @param mass
    * @param angularMass
    */
-  TPhysicsAttributes( double mass, double angularMass );
+  TPhysicsAttributes( TScalar mass, TScalar angularMass );
 
   /**
    * Calculates physics attributes for rectangle with density and size.
@@ -23,7 +23,7 @@ struct TPhysicsAttributes
    * @param size
    * @return Physics attributes of rectangle.
    */
-  static TPhysicsAttributes rectangleAttributes( double density, const TVector<2> &size );
+  static TPhysicsAttributes rectangleAttributes( TScalar density, const TVector<2> &size );
 
   /**
    * Calculates physics attributes for circle with density and radius.
@@ -32,7 +32,7 @@ struct TPhysicsAttributes
    * @param radius
    * @return Physics attributes of circle.
    */
-  static TPhysicsAttributes circleAttributes( double density, double radius );
+  static TPhysicsAttributes circleAttributes( TScalar density, TScalar radius );
 
   /**
    * Calculates physics attributes for complex object with density, width and points.
@@ -43,8 +43,8 @@ struct TPhysicsAttributes
    * @param points
    * @return Physics attributes of complex object.
    */
-  static TPhysicsAttributes complexObjectAttributes( double width,
-                                                     double density,
+  static TPhysicsAttributes complexObjectAttributes( TScalar width,
+                                                     TScalar density,
                                                      std::vector<TVector<2>> points );
 
   /**
@@ -55,27 +55,27 @@ struct TPhysicsAttributes
   /**
    * Angular velocity of object. ( Clockwise )
    */
-  double angularVelocity = 0;
+  TScalar angularVelocity = 0;
 
   /**
    * Object mass.
    */
-  double mass;
+  TScalar mass;
 
   /**
    * Object inverse mass. ( 1 / mass )
    */
-  double invMass;
+  TScalar invMass;
 
   /**
    * Object angular mass.
    */
-  double angularMass;
+  TScalar angularMass;
 
   /**
    * Object inverse angular mass. ( 1 / angular mass )
    */
-  double invAngularMass;
+  TScalar invAngularMass;
 
   /**
    * Accumulator for force.
@@ -85,20 +85,20 @@ struct TPhysicsAttributes
   /**
    * Accumulator for moment. ( Torque )
    */
-  double momentAccumulator = 0;
+  TScalar momentAccumulator = 0;
 
   /**
    * Object elasticity. Percentage of energy preserved on normal collision.
    */
-  double elasticity = 0.8;
+  TScalar elasticity = 0.8;
 
   /**
    * Object friction coefficient. Upper limit to friction force.
    */
-  double frictionCoefficient = 0.5;
+  TScalar frictionCoefficient = 0.5;
 
   /**
    * Accumulator for object collision damage.
    */
-  double integrity = 1;
+  TScalar integrity = 1;
 };
@@ -1,84 +1,386 @@
 #include "physicsEngine.hpp"
+#include "shapeDispatch.hpp"
 #include "object.hpp"
+#include <stdexcept>
 
 
 using namespace std;
 
+const size_t CPhysicsEngine::minParallelPairs = 64;
+const TScalar CPhysicsEngine::sleepVelocity = 10;
+const TScalar CPhysicsEngine::sleepDistance = 2;
+const size_t CPhysicsEngine::sleepFrames = 25;
+const TScalar CPhysicsEngine::continuousSlop = 1;
+
 
 void CPhysicsEngine::addField( CForceField field )
 {
   m_fields.emplace_back( move( field ) );
+  m_wakeAll = true;
+}
+
+void CPhysicsEngine::setBroadPhase( unique_ptr<CBroadPhase> broadPhase )
+{
+  if( !broadPhase )
+    throw invalid_argument( "Broad-phase must not be empty.\n" );
+  m_broadPhase = move( broadPhase );
+}
+
+void CPhysicsEngine::setThreadCount( size_t threadCount )
+{
+  if( threadCount > 1 )
+    m_threadPool = make_unique<CThreadPool>( threadCount );
+  else
+    m_threadPool.reset();
+  m_workerArenas.clear();
+  for( size_t worker = 1; worker < threadCount; ++worker )
+    m_workerArenas.push_back( make_unique<CFrameArena>() );
+}
+
+void CPhysicsEngine::setSleeping( bool enabled )
+{
+  m_sleeping = enabled;
+  m_wakeAll = true;
+}
+
+void CPhysicsEngine::setSolver( const TSolverSettings &settings )
+{
+  m_solverSettings = settings;
+}
+
+void CPhysicsEngine::setContactBeginCallback( CContactCache::TContactCallback callback )
+{
+  m_contacts.setBeginCallback( move( callback ) );
+}
+
+void CPhysicsEngine::setContactEndCallback( CContactCache::TContactCallback callback )
+{
+  m_contacts.setEndCallback( move( callback ) );
+}
+
+const CFrameArena &CPhysicsEngine::frameArena() const
+{
+  return m_arena;
 }
 
 void CPhysicsEngine::reset()
 {
   frame = 0;
   m_fields.clear();
+  m_wakeAll = true;
+  PHYSICS_PROFILE( stepHistogram.clear() );
+  m_broadPhase->reset();
+  m_solver.reset();
+  m_contacts.reset();
 }
 
-vector<TManifold> CPhysicsEngine::step( vector<CPhysicsObject *> &objects, double dt )
+TManifoldList CPhysicsEngine::step( vector<CPhysicsObject *> &objects, TScalar dt )
 {
+  m_arena.reset();
+  for( auto &arena: m_workerArenas )
+    arena->reset();
+  PHYSICS_PROFILE( lastStep = {} );
+  PHYSICS_PROFILE( CPhaseClock phaseClock );
+
+  if( m_wakeAll )
+  {
+    for( auto object: objects )
+      object->wake();
+    m_wakeAll = false;
+  }
+
   accumulateForces( objects );
+  PHYSICS_PROFILE( lastStep.accumulateForces += phaseClock.lap() );
   applyForces( objects, dt );
+  PHYSICS_PROFILE( lastStep.applyForces += phaseClock.lap() );
 
-  vector<TManifold> allCollisions = findCollisions( objects );
+  TManifoldList allCollisions = findCollisions( objects );
+  PHYSICS_PROFILE( lastStep.search[ 0 ] = { phaseClock.lap(), m_pairTests, allCollisions.size() } );
 
   applyImpulses( allCollisions );
+  PHYSICS_PROFILE( lastStep.impulses += phaseClock.lap() );
   resolveCollisions( allCollisions );
+  PHYSICS_PROFILE( lastStep.resolution += phaseClock.lap() );
 
-  for( size_t iteration = 0; iteration < 1; ++iteration )
+  for( size_t iteration = 0; iteration < m_solverSettings.positionIterations; ++iteration )
   {
-    vector<TManifold> collisions = findCollisions( objects );
+    TManifoldList collisions = findCollisions( objects );
+    PHYSICS_PROFILE( lastStep.search[ 1 ].time += phaseClock.lap() );
+    PHYSICS_PROFILE( lastStep.search[ 1 ].pairTests += m_pairTests );
+    PHYSICS_PROFILE( lastStep.search[ 1 ].manifolds += collisions.size() );
     resolveCollisions( collisions );
-    allCollisions.insert( allCollisions.end(), collisions.begin(), collisions.end() );
+    allCollisions.insert( allCollisions.end(), make_move_iterator( collisions.begin() ),
+                          make_move_iterator( collisions.end() ) );
+    PHYSICS_PROFILE( lastStep.resolution += phaseClock.lap() );
   }
+
+  if( m_sleeping )
+    updateSleeping( objects, dt );
+  m_contacts.update( allCollisions, frame );
+
+#ifdef PHYSICS_PROFILING
+  for( const auto &collision: allCollisions )
+    lastStep.contacts += collision.contacts.size();
+  stepHistogram.add( lastStep.total() );
+#endif
   ++frame;
   return allCollisions;
 }
 
 void CPhysicsEngine::accumulateForces( vector<CPhysicsObject *> &objects )
 {
-  for( auto &item: objects )
+  bool functorFields = any_of( m_fields.begin(), m_fields.end(), []( const CForceField &field )
+  {
+    return field.m_type == EFieldType::FUNCTOR;
+  } );
+  m_bodies.resize( objects.size() );
+  m_sweepStarts.clear();
+  m_sweepObstacles.clear();
+  for( size_t idx = 0; idx < objects.size(); ++idx )
   {
-    item->resetAccumulator();
+    auto &item = *objects[ idx ];
+    m_bodies.gather( idx, item );
+    if( item.m_continuous && !item.m_sleeping && item.m_attributes.invMass != 0 &&
+        !( item.m_tag & ETag::NON_SOLID ) )
+      m_sweepStarts.push_back( { idx, item.m_position, item.m_rotation } );
+    if( item.m_shapeType == EShapeType::RECTANGLE && !( item.m_tag & ETag::NON_SOLID ) )
+      m_sweepObstacles.push_back( idx );
+
+    item.resetAccumulator();
+    if( item.m_sleeping || !functorFields )
+      continue;
     for( const auto &field: m_fields )
-      field.applyForce( *item );
+      field.applyForce( item );
+    m_bodies.addForce( idx, item.m_attributes.forceAccumulator,
+                       item.m_attributes.momentAccumulator );
   }
+  for( const auto &field: m_fields )
+    field.applyForces( m_bodies );
 }
 
-void CPhysicsEngine::applyForces( vector<CPhysicsObject *> &objects, double dt )
+void CPhysicsEngine::applyForces( vector<CPhysicsObject *> &objects, TScalar dt )
 {
-  for( auto &item: objects )
-    item->applyForce( dt );
+  m_bodies.integrate( dt );
+  m_bodies.scatter( objects );
+
+  if( m_sweepStarts.empty() )
+    return;
+  findSweepCandidates( objects );
+  sweepContinuous( objects );
 }
 
-vector<TManifold> CPhysicsEngine::findCollisions( vector<CPhysicsObject *> &objects )
+void CPhysicsEngine::findSweepCandidates( const vector<CPhysicsObject *> &objects )
 {
-  vector<TManifold> collisions;
-  for( size_t a = 0; a < objects.size(); ++a )
-    for( size_t b = a + 1; b < objects.size(); ++b )
+  m_sweepBounds.clear();
+  for( size_t idx = 0; idx < m_sweepStarts.size(); ++idx )
+  {
+    const auto &start = m_sweepStarts[ idx ];
+    const auto &object = *objects[ start.object ];
+    TBoundingBox box = TBoundingBox::around( start.position, object.m_boundingRadius );
+    box.merge( TBoundingBox::around( object.m_position, object.m_boundingRadius ) );
+    m_sweepBounds.push_back( { box, idx, true } );
+  }
+  for( size_t idx: m_sweepObstacles )
+  {
+    const auto &obstacle = *objects[ idx ];
+    m_sweepBounds.push_back( { TBoundingBox::around( obstacle.m_position, obstacle.m_boundingRadius ),
+                               idx, false } );
+  }
+  sort( m_sweepBounds.begin(), m_sweepBounds.end(), []( const TSweepBound &first, const TSweepBound &second )
+  {
+    return first.box.min[ 0 ] < second.box.min[ 0 ];
+  } );
+
+  m_sweepCandidates.clear();
+  m_activeBounds.clear();
+  for( const auto &bound: m_sweepBounds )
+  {
+    m_activeBounds.erase( remove_if( m_activeBounds.begin(), m_activeBounds.end(),
+                                     [ &bound ]( const TSweepBound &active )
+                                     {
+                                       return active.box.max[ 0 ] < bound.box.min[ 0 ];
+                                     } ), m_activeBounds.end() );
+    for( const auto &active: m_activeBounds )
+    {
+      if( active.sweep == bound.sweep || !active.box.overlaps( bound.box ) )
+        continue;
+      if( bound.sweep )
+        m_sweepCandidates.emplace_back( bound.index, active.index );
+      else
+        m_sweepCandidates.emplace_back( active.index, bound.index );
+    }
+    m_activeBounds.push_back( bound );
+  }
+  sort( m_sweepCandidates.begin(), m_sweepCandidates.end() );
+}
+
+void CPhysicsEngine::sweepContinuous( vector<CPhysicsObject *> &objects ) const
+{
+  auto candidate = m_sweepCandidates.begin();
+  for( size_t idx = 0; idx < m_sweepStarts.size(); ++idx )
+  {
+    const auto &start = m_sweepStarts[ idx ];
+    auto &object = *objects[ start.object ];
+    TVector<2> motion = object.m_position - start.position;
+    TScalar distance = motion.norm();
+
+    TScalar firstImpact = HUGE_VAL;
+    for( ; candidate != m_sweepCandidates.end() && candidate->first == idx; ++candidate )
     {
-      if( objects[ a ]->m_boundingRadius + objects[ b ]->m_boundingRadius <
-          ( objects[ a ]->m_position - objects[ b ]->m_position ).norm() )
+      const auto obstacle = objects[ candidate->second ];
+      if( obstacle == &object )
+        continue;
+      TVector<2> closest = distance > 0 ? collision::lineSegmentClosestPoint( start.position,
+                                                                              object.m_position,
+                                                                              obstacle->m_position )
+                                        : start.position;
+      if( closest.distance( obstacle->m_position ) > obstacle->m_boundingRadius + object.m_boundingRadius )
         continue;
-      TManifold collision = objects[ a ]->getManifold( objects[ b ] );
-      if( collision )
-        collisions.push_back( collision );
+      firstImpact = min( firstImpact, obstacle->sweptBy( object, start.position, start.rotation ) );
     }
+    if( firstImpact > 1 )
+      continue;
+
+    TScalar impact = distance > 0 ? min<TScalar>( firstImpact + continuousSlop / distance, 1 ) : firstImpact;
+    object.m_position = start.position + motion * impact;
+    object.rotate( ( start.rotation - object.m_rotation ) * ( 1 - impact ) );
+  }
+}
+
+TManifoldList CPhysicsEngine::findCollisions( vector<CPhysicsObject *> &objects )
+{
+  CFrameArena::CScope arenaScope( m_arena );
+  TManifoldList collisions;
+  const auto &pairs = m_broadPhase->findPairs( objects );
+  PHYSICS_PROFILE( m_pairTests = pairs.size() );
+  if( m_threadPool && pairs.size() >= minParallelPairs )
+    findCollisionsParallel( objects, pairs, collisions );
+  else
+    m_narrowPhase.findCollisions( objects, pairs, collisions );
+
+  if( m_sleeping )
+    wakeTouched( collisions );
+  if( m_threadPool || m_sleeping )
+    m_islands.build( collisions );
   return collisions;
 }
 
-void CPhysicsEngine::applyImpulses( vector<TManifold> &manifolds )
+void CPhysicsEngine::findCollisionsParallel( vector<CPhysicsObject *> &objects,
+                                             const vector<TCandidatePair> &pairs,
+                                             TManifoldList &collisions )
 {
-  for( auto &manifold: manifolds )
+  reserveDoubling( m_pairManifolds, pairs.size() );
+  m_pairManifolds.assign( pairs.size(), { nullptr, nullptr } );
+  m_threadPool->parallelFor( pairs.size(), [ this, &objects, &pairs ]( size_t idx )
+  {
+    size_t thread = m_threadPool->threadIndex();
+    CFrameArena::CScope arenaScope( thread ? *m_workerArenas[ thread - 1 ] : m_arena );
+    const auto &[ a, b ] = pairs[ idx ];
+    if( !CContactCache::restingPair( *objects[ a ], *objects[ b ] ) )
+      m_pairManifolds[ idx ] = collision::getManifold( objects[ a ], objects[ b ] );
+  } );
+
+  for( auto &manifold: m_pairManifolds )
+    if( manifold )
+      collisions.push_back( move( manifold ) );
+}
+
+void CPhysicsEngine::wakeTouched( const TManifoldList &collisions )
+{
+  for( const auto &collision: collisions )
+  {
+    if( collision.first->m_tag & ETag::NON_SOLID ||
+        collision.second->m_tag & ETag::NON_SOLID )
+      continue;
+    if( collision.first->m_sleeping && !collision.second->m_sleeping )
+      collision.first->wake();
+    else if( collision.second->m_sleeping && !collision.first->m_sleeping )
+      collision.second->wake();
+  }
+}
+
+void CPhysicsEngine::updateSleeping( vector<CPhysicsObject *> &objects, TScalar dt )
+{
+  auto awake = []( const CPhysicsObject *object )
+  {
+    return !object->m_sleeping && object->m_attributes.invMass != 0;
+  };
+
+  reserveDoubling( m_islandRest, m_islands.size() );
+  m_islandRest.assign( m_islands.size(), SIZE_MAX );
+  for( auto object: objects )
+  {
+    if( !awake( object ) )
+      continue;
+    const auto &attributes = object->m_attributes;
+    object->m_restAngle += attributes.angularVelocity * dt;
+    bool resting = attributes.velocity.squareNorm() < sleepVelocity * sleepVelocity &&
+                   ( object->m_position - object->m_restPosition ).squareNorm() < sleepDistance * sleepDistance &&
+                   abs( object->m_restAngle ) * object->m_boundingRadius < sleepDistance;
+    object->m_restFrames = resting ? object->m_restFrames + 1 : 0;
+    // distance is measured over windows of sleepFrames, so slow settling of piles does not wake them
+    if( object->m_restFrames % sleepFrames == 0 )
+    {
+      object->m_restPosition = object->m_position;
+      object->m_restAngle = 0;
+    }
+
+    size_t island = m_islands.islandOf( object );
+    if( island != SIZE_MAX )
+      m_islandRest[ island ] = min( m_islandRest[ island ], object->m_restFrames );
+  }
+
+  for( auto object: objects )
   {
-    if( manifold.first->m_tag & ETag::NON_SOLID ||
-        manifold.second->m_tag & ETag::NON_SOLID )
+    if( !awake( object ) )
       continue;
-    applyImpulse( manifold );
+    size_t island = m_islands.islandOf( object );
+    size_t restFrames = island == SIZE_MAX ? object->m_restFrames : m_islandRest[ island ];
+    if( restFrames >= sleepFrames )
+      object->sleep();
   }
 }
 
+void CPhysicsEngine::applyImpulses( TManifoldList &manifolds )
+{
+  if( !m_solverSettings.iterative() )
+  {
+    solveSolid( manifolds, 1, [ &manifolds ]( size_t idx ){ applyImpulse( manifolds[ idx ] ); } );
+    return;
+  }
+
+  m_solver.prepare( manifolds, m_solverSettings.warmStarting );
+  solveSolid( manifolds, m_solverSettings.velocityIterations, [ this, &manifolds ]( size_t idx )
+  {
+    m_solver.solve( manifolds, idx );
+  } );
+  m_solver.finish( manifolds );
+}
+
+void CPhysicsEngine::solveSolid( TManifoldList &manifolds, size_t passes,
+                                 const function<void( size_t )> &solve )
+{
+  if( m_threadPool && m_islands.size() > 1 )
+  {
+    m_threadPool->parallelFor( m_islands.size(), [ this, passes, &solve ]( size_t island )
+    {
+      for( size_t pass = 0; pass < passes; ++pass )
+        for( size_t idx: m_islands[ island ] )
+          solve( idx );
+    } );
+    return;
+  }
+
+  for( size_t pass = 0; pass < passes; ++pass )
+    for( size_t idx = 0; idx < manifolds.size(); ++idx )
+    {
+      if( manifolds[ idx ].first->m_tag & ETag::NON_SOLID ||
+          manifolds[ idx ].second->m_tag & ETag::NON_SOLID )
+        continue;
+      solve( idx );
+    }
+}
+
 void CPhysicsEngine::applyImpulse( const TManifold &manifold )
 {
   for( const auto &contactPoint: manifold.contacts )
@@ -97,7 +399,7 @@ void CPhysicsEngine::applyImpulse( CPhysicsObject &first,
   second.applyImpulse( -normalImpulse, contactPoint.contactPoint );
 
   TVector<2> frictionImpulse = getFrictionImpulse( first, second, contactPoint );
-  double frictionCoefficientSq = first.m_attributes.frictionCoefficient
+  TScalar frictionCoefficientSq = first.m_attributes.frictionCoefficient
                                  * second.m_attributes.frictionCoefficient;
 
   if( frictionImpulse.squareNorm() > frictionCoefficientSq * normalImpulse.squareNorm() )
@@ -121,8 +423,8 @@ TVector<2> CPhysicsEngine::getNormalImpulse( CPhysicsObject &first,
   TVector<2> relativeVelocity = getRelativeVelocity( first, second,
                                                      collisionPoint );
 
-  double elasticity = firstAttr.elasticity * secondAttr.elasticity;
-  double velocityProjection = collisionNormal.dot( relativeVelocity );
+  TScalar elasticity = firstAttr.elasticity * secondAttr.elasticity;
+  TScalar velocityProjection = collisionNormal.dot( relativeVelocity );
   if( velocityProjection >= 0 )
     return { NAN, NAN };
 
@@ -145,7 +447,7 @@ TVector<2> CPhysicsEngine::getFrictionImpulse( CPhysicsObject &first,
   TVector<2> relativeVelocity = getRelativeVelocity( first, second,
                                                      collisionPoint );
 
-  double frictionCoefficient = firstAttr.frictionCoefficient * secondAttr.frictionCoefficient;
+  TScalar frictionCoefficient = firstAttr.frictionCoefficient * secondAttr.frictionCoefficient;
 
   return ( 1 + frictionCoefficient ) *
          collisionTangent.dot( relativeVelocity ) *
@@ -163,37 +465,31 @@ TVector<2> CPhysicsEngine::getRelativeVelocity( const CPhysicsObject &first,
 }
 
 
-double CPhysicsEngine::getCombinedInvMass( const CPhysicsObject &first,
-                                           const CPhysicsObject &second,
-                                           const TVector<2> &point,
-                                           const TVector<2> &direction )
+TScalar CPhysicsEngine::getCombinedInvMass( const CPhysicsObject &first,
+                                            const CPhysicsObject &second,
+                                            const TVector<2> &point,
+                                            const TVector<2> &direction )
 {
   TVector<2> directionNormalized = direction.normalized();
   return 1 / ( getObjectInvMass( first, point, directionNormalized ) +
                getObjectInvMass( second, point, directionNormalized ) );
 }
 
-double CPhysicsEngine::getObjectInvMass( const CPhysicsObject &object,
-                                         const TVector<2> &point,
-                                         const TVector<2> &direction )
+TScalar CPhysicsEngine::getObjectInvMass( const CPhysicsObject &object,
+                                          const TVector<2> &point,
+                                          const TVector<2> &direction )
 {
-  double linearInvMass = object.m_attributes.invMass;
+  TScalar linearInvMass = object.m_attributes.invMass;
   TVector<2> lever = point - object.m_position;
 
-  double angMass = pow( lever.dot( crossProduct( direction ) ), 2 ) * object.m_attributes.invAngularMass;
+  TScalar angMass = pow( lever.dot( crossProduct( direction ) ), 2 ) * object.m_attributes.invAngularMass;
 
   return linearInvMass + angMass;
 }
 
-void CPhysicsEngine::resolveCollisions( std::vector<TManifold> &collisions )
+void CPhysicsEngine::resolveCollisions( TManifoldList &collisions )
 {
-  for( auto &collision: collisions )
-  {
-    if( collision.first->m_tag & ETag::NON_SOLID ||
-        collision.second->m_tag & ETag::NON_SOLID )
-      continue;
-    resolveCollision( collision );
-  }
+  solveSolid( collisions, 1, [ &collisions ]( size_t idx ){ resolveCollision( collisions[ idx ] ); } );
 }
 
 void CPhysicsEngine::resolveCollision( const TManifold &collision )
@@ -201,7 +497,7 @@ void CPhysicsEngine::resolveCollision( const TManifold &collision )
   TVector<2> overlapVector;
   for( const auto &contactPoint: collision.contacts )
     overlapVector += contactPoint.overlapVector;
-  overlapVector /= (double)collision.contacts.size() * 2;
+  overlapVector /= (TScalar)collision.contacts.size() * 2;
   resolveCollision( *collision.first, *collision.second, overlapVector );
 }
 
@@ -209,10 +505,13 @@ void CPhysicsEngine::resolveCollision( CPhysicsObject &first,
                                        CPhysicsObject &second,
                                        const TVector<2> &overlapVector )
 {
-  double linearInvMass = 1 / ( first.m_attributes.invMass +
-                               second.m_attributes.invMass );
+  TScalar linearInvMass = 1 / ( first.m_attributes.invMass +
+                                second.m_attributes.invMass );
   if( !isnormal( linearInvMass ) )
     return;
-  first.m_position -= overlapVector * linearInvMass * first.m_attributes.invMass;
-  second.m_position += overlapVector * linearInvMass * second.m_attributes.invMass;
+  // static objects are shared by contact islands, they must not be written to
+  if( first.m_attributes.invMass != 0 )
+    first.m_position -= overlapVector * linearInvMass * first.m_attributes.invMass;
+  if( second.m_attributes.invMass != 0 )
+    second.m_position += overlapVector * linearInvMass * second.m_attributes.invMass;
 }
@@ -4,6 +4,16 @@
 #include "physicsAttributes.hpp"
 #include "manifold.hpp"
 #include "forceField.hpp"
+#include "broadPhase.hpp"
+#include "physicsProfiler.hpp"
+#include "bodyStore.hpp"
+#include "threadPool.hpp"
+#include "contactIslands.hpp"
+#include "contactSolver.hpp"
+#include "contactCache.hpp"
+#include "narrowPhase.hpp"
+#include "frameArena.hpp"
+#include "segmentTree.hpp"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -20,11 +30,13 @@ class CPhysicsEngine
 public:
   /**
    * Does single time step with time delta dt on objects.
+   * Temporaries of previous step are released, so collisions returned by previous step
+   * must not be used anymore.
    * @param objects
    * @param dt
-   * @return Vector of all collisions.
+   * @return Vector of all collisions, valid until next step.
    */
-  std::vector<TManifold> step( std::vector<CPhysicsObject *> &objects, double dt );
+  TManifoldList step( std::vector<CPhysicsObject *> &objects, TScalar dt );
 
   /**
    * Adds field to engine.
@@ -33,40 +45,195 @@ public:
   void addField( CForceField field );
 
   /**
-   * Resets engine. Erases all fields.
+   * Replaces broad-phase used for collision search.
+   * CBruteForceBroadPhase restores original all pairs search.
+   * @param broadPhase
+   * @throws std::invalid_argument if broadPhase is empty.
+   */
+  void setBroadPhase( std::unique_ptr<CBroadPhase> broadPhase );
+
+  /**
+   * Sets number of threads used for exact collision tests and collision resolution.
+   * Collisions are resolved by islands of touching objects, each island on one thread.
+   * Results are same for any thread count.
+   * @param threadCount 1 for single threaded collision search
+   */
+  void setThreadCount( size_t threadCount );
+
+  /**
+   * Enables or disables sleeping of resting objects.
+   * Objects staying near same place for sleepFrames frames are put to sleep,
+   * touching objects sleep together. Sleeping objects are not integrated and
+   * are not tested against other sleeping or static objects.
+   * They are woken by collision with awake object or by field change.
+   * @param enabled
+   */
+  void setSleeping( bool enabled );
+
+  /**
+   * Sets collision response. Default settings keep original single impulse pass,
+   * more velocity iterations or warm starting use sequential impulse solver.
+   * @param settings
+   */
+  void setSolver( const TSolverSettings &settings );
+
+  /**
+   * Sets function called in step for each pair of objects which started touching.
+   * @param callback
+   */
+  void setContactBeginCallback( CContactCache::TContactCallback callback );
+
+  /**
+   * Sets function called in step for each pair of objects which stopped touching.
+   * Sleeping objects resting on each other or on static object keep touching.
+   * @param callback
+   */
+  void setContactEndCallback( CContactCache::TContactCallback callback );
+
+  /**
+   * Resets engine. Erases all fields, forgets touching pairs and cached contact impulses
+   * and wakes all objects in next step.
    */
   void reset();
 
+  /**
+   * @return Arena of step temporaries.
+   */
+  [[nodiscard]] const CFrameArena &frameArena() const;
+
   /**
    * Frames elapsed from last reset / start.
    */
   size_t frame = 0;
+
+#ifdef PHYSICS_PROFILING
+  /**
+   * Statistics of last step. Exists only if built with PHYSICS_PROFILING.
+   */
+  TStepStatistics lastStep;
+
+  /**
+   * Rolling histogram of step times. Exists only if built with PHYSICS_PROFILING.
+   */
+  CStepHistogram stepHistogram;
+#endif
 private:
   /**
-   * Accumulates all forces acting on all objects.
+   * Gathers objects to body store, records start poses of continuous objects
+   * and accumulates all forces acting on objects. All is done in single pass over objects.
+   * Fields given by function are applied to each object, built-in fields by loops over body store.
    * @param objects
    */
   void accumulateForces( std::vector<CPhysicsObject *> &objects );
 
   /**
-   * Applies accumulated forces to all objects.
+   * Applies accumulated forces in body store and writes result to objects.
+   * Continuous objects are then swept against rectangles from poses recorded by accumulateForces.
    * @param objects
    * @param dt time step
    */
-  static void applyForces( std::vector<CPhysicsObject *> &objects, double dt );
+  void applyForces( std::vector<CPhysicsObject *> &objects, TScalar dt );
+
+  /**
+   * Finds rectangles which continuous objects may hit in this step. Box around start
+   * and end of movement of each continuous object is swept along x axis together with
+   * boxes of rectangles recorded by accumulateForces, pairs of overlapping boxes are candidates.
+   * @param objects
+   */
+  void findSweepCandidates( const std::vector<CPhysicsObject *> &objects );
 
   /**
-   * Finds all collisions.
+   * Moves continuous objects back along their movement to first impact with rectangle.
+   * Only rectangles found by findSweepCandidates are tested, other shapes are never hit by sweep.
+   * Objects are left slightly overlapping, so impact is resolved by collision search.
+   * @param objects
+   */
+  void sweepContinuous( std::vector<CPhysicsObject *> &objects ) const;
+
+  /**
+   * Distance continuous object moves past time of impact.
+   */
+  static const TScalar continuousSlop;
+
+  /**
+   * Pose of continuous object at start of step.
+   */
+  struct TSweepStart
+  {
+    size_t object;
+    TVector<2> position;
+    TScalar rotation;
+  };
+
+  /**
+   * Bounding box of movement of continuous object or of rectangle.
+   */
+  struct TSweepBound
+  {
+    TBoundingBox box;
+
+    /**
+     * Index to m_sweepStarts for continuous object, index to objects for rectangle.
+     */
+    size_t index;
+
+    /**
+     * True for continuous object.
+     */
+    bool sweep;
+  };
+
+  /**
+   * Finds all collisions. Only pairs found by broad-phase are tested.
+   * If multithreaded, contact islands of returned collisions are built.
+   * Manifolds found on calling thread are allocated in frame arena.
    * @param objects
    * @return Vector of all collisions.
    */
-  static std::vector<TManifold> findCollisions( std::vector<CPhysicsObject *> &objects );
+  TManifoldList findCollisions( std::vector<CPhysicsObject *> &objects );
 
   /**
-   * Resolves collision by pushing ( m_position translation ) objects according to overlap vector.
+   * Tests candidate pairs on thread pool.
+   * Collisions are stored in order of pairs, regardless of thread count.
+   * @param objects
+   * @param pairs candidate pairs
+   * @param collisions storage for collisions
+   */
+  void findCollisionsParallel( std::vector<CPhysicsObject *> &objects,
+                               const std::vector<TCandidatePair> &pairs,
+                               TManifoldList &collisions );
+
+  /**
+   * Smallest number of candidate pairs worth distributing to threads.
+   */
+  static const size_t minParallelPairs;
+
+  /**
+   * Objects slower than sleepVelocity, which did not move nor rotate ( measured
+   * on bounding radius ) further than sleepDistance for sleepFrames consecutive frames can sleep.
+   * Distance is measured from start of each sleepFrames window, because resting objects jitter.
+   */
+  static const TScalar sleepVelocity, sleepDistance;
+  static const size_t sleepFrames;
+
+  /**
+   * Wakes sleeping objects in solid collision with awake objects.
    * @param collisions
    */
-  static void resolveCollisions( std::vector<TManifold> &collisions );
+  static void wakeTouched( const TManifoldList &collisions );
+
+  /**
+   * Updates resting frames of objects and puts resting islands to sleep.
+   * @param objects
+   * @param dt time step
+   */
+  void updateSleeping( std::vector<CPhysicsObject *> &objects, TScalar dt );
+
+  /**
+   * Resolves collision by pushing ( m_position translation ) objects according to overlap vector.
+   * @param collisions collisions from last findCollisions
+   */
+  void resolveCollisions( TManifoldList &collisions );
 
   /**
    * Resolves single collision.
@@ -85,9 +252,19 @@ private:
 
   /**
    * Applies impulses to all colliding objects ( velocity, angular velocity update )
-   * @param manifolds
+   * @param manifolds collisions from last findCollisions
+   */
+  void applyImpulses( TManifoldList &manifolds );
+
+  /**
+   * Calls solve for indices of all solid manifolds, passes times.
+   * Manifolds in same island are solved in their order, islands are distributed to threads.
+   * @param manifolds collisions from last findCollisions
+   * @param passes
+   * @param solve
    */
-  static void applyImpulses( std::vector<TManifold> &manifolds );
+  void solveSolid( TManifoldList &manifolds, size_t passes,
+                   const std::function<void( size_t )> &solve );
 
   /**
    * Applies impulse caused by single collision.
@@ -143,10 +320,10 @@ private:
    * @param direction
    * @return
    */
-  static double getCombinedInvMass( const CPhysicsObject &first,
-                                    const CPhysicsObject &second,
-                                    const TVector<2> &point,
-                                    const TVector<2> &direction );
+  static TScalar getCombinedInvMass( const CPhysicsObject &first,
+                                     const CPhysicsObject &second,
+                                     const TVector<2> &point,
+                                     const TVector<2> &direction );
 
   /**
    * Calculates harmonic sum of object mass and angular mass.
@@ -156,12 +333,111 @@ private:
    * @param direction
    * @return
    */
-  static double getObjectInvMass( const CPhysicsObject &object,
-                                  const TVector<2> &point,
-                                  const TVector<2> &direction );
+  static TScalar getObjectInvMass( const CPhysicsObject &object,
+                                   const TVector<2> &point,
+                                   const TVector<2> &direction );
 
   /**
    * Vector of field acting on objects.
    */
   std::vector<CForceField> m_fields;
+
+  /**
+   * State of bodies for force integration.
+   */
+  TBodyStore m_bodies;
+
+  /**
+   * Broad-phase used for collision search.
+   */
+  std::unique_ptr<CBroadPhase> m_broadPhase = std::make_unique<CSweepAndPruneBroadPhase>();
+
+  /**
+   * Exact collision tests of single threaded collision search.
+   */
+  CNarrowPhase m_narrowPhase;
+
+  /**
+   * Workers for collision tests. Null if single threaded.
+   */
+  std::unique_ptr<CThreadPool> m_threadPool;
+
+  /**
+   * Islands of collisions found by last findCollisions.
+   * Built only if multithreaded or sleeping is enabled.
+   */
+  CContactIslands m_islands;
+
+  /**
+   * Settings of collision response.
+   */
+  TSolverSettings m_solverSettings;
+
+  /**
+   * Sequential impulse solver, used if settings are iterative.
+   */
+  CContactSolver m_solver;
+
+  /**
+   * Pairs of touching objects.
+   */
+  CContactCache m_contacts;
+
+  /**
+   * Start poses of continuous objects in current step.
+   */
+  std::vector<TSweepStart> m_sweepStarts;
+
+  /**
+   * Solid rectangles in current step, as indices to objects.
+   */
+  std::vector<size_t> m_sweepObstacles;
+
+  /**
+   * Boxes of continuous objects and rectangles sorted by left side, and boxes
+   * of current sweep position, reused between steps.
+   */
+  std::vector<TSweepBound> m_sweepBounds, m_activeBounds;
+
+  /**
+   * Index to m_sweepStarts and index of rectangle which it may hit, sorted.
+   */
+  std::vector<std::pair<size_t, size_t>> m_sweepCandidates;
+
+  /**
+   * Minimal resting frames of objects in each island.
+   */
+  std::vector<size_t> m_islandRest;
+
+  /**
+   * True if sleeping is enabled.
+   */
+  bool m_sleeping = false;
+
+  /**
+   * True if all objects should be woken in next step.
+   */
+  bool m_wakeAll = false;
+
+  /**
+   * Memory of manifolds and their contacts, reset at start of each step.
+   */
+  CFrameArena m_arena;
+
+  /**
+   * Frame arena of each worker of thread pool, used for manifolds found on worker.
+   */
+  std::vector<std::unique_ptr<CFrameArena>> m_workerArenas;
+
+  /**
+   * Result of each candidate pair in parallel collision search.
+   */
+  std::vector<TManifold> m_pairManifolds;
+
+#ifdef PHYSICS_PROFILING
+  /**
+   * Pairs tested in last collision search.
+   */
+  size_t m_pairTests = 0;
+#endif
 };
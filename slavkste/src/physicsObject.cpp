@@ -3,14 +3,16 @@
 
 using namespace std;
 
-CPhysicsObject::CPhysicsObject( TVector<2> position,
+CPhysicsObject::CPhysicsObject( EShapeType shapeType,
+                                TVector<2> position,
                                 const TPhysicsAttributes &attributes,
-                                double angle )
+                                TScalar angle )
   : CObject( position ),
+    m_shapeType( shapeType ),
     m_attributes( attributes ),
     m_rotation( angle ){}
 
-CPhysicsObject &CPhysicsObject::rotate( double angle )
+CPhysicsObject &CPhysicsObject::rotate( TScalar angle )
 {
   m_rotation += angle;
   return *this;
@@ -22,29 +24,31 @@ void CPhysicsObject::resetAccumulator()
   m_attributes.momentAccumulator = 0;
 }
 
-void CPhysicsObject::applyForce( double dt )
+void CPhysicsObject::applyImpulse( const TVector<2> &impulse, const TVector<2> &point )
 {
-  if( m_attributes.invMass == 0 )
-    return;
-  m_attributes.velocity += m_attributes.invMass * m_attributes.forceAccumulator * dt;
-  m_attributes.angularVelocity += m_attributes.invAngularMass * m_attributes.momentAccumulator * dt;
-
-  m_position += m_attributes.velocity * dt;
-  rotate( m_attributes.angularVelocity * dt );
+  applyVelocityImpulse( impulse, point );
+  applyDamage( impulse );
 }
 
-void CPhysicsObject::applyImpulse( const TVector<2> &impulse, const TVector<2> &point )
+void CPhysicsObject::applyVelocityImpulse( const TVector<2> &impulse, const TVector<2> &point )
 {
+  if( m_attributes.invMass == 0 )
+    return;
   m_attributes.velocity += m_attributes.invMass * impulse;
 
   TVector<2> lever = point - m_position;
 
   m_attributes.angularVelocity += lever.dot( crossProduct( impulse ) ) *
                                   m_attributes.invAngularMass;
+}
 
-  double offset = 8;
-  double scale = 2000;
-  m_attributes.integrity -= max( impulse.norm() * m_attributes.invMass - offset, 0. ) / scale;
+void CPhysicsObject::applyDamage( const TVector<2> &impulse )
+{
+  if( m_attributes.invMass == 0 )
+    return;
+  TScalar offset = 8;
+  TScalar scale = 2000;
+  m_attributes.integrity -= max<TScalar>( impulse.norm() * m_attributes.invMass - offset, 0 ) / scale;
 }
 
 TVector<2> CPhysicsObject::getLocalVelocity( const TVector<2> &point ) const
@@ -54,20 +58,45 @@ TVector<2> CPhysicsObject::getLocalVelocity( const TVector<2> &point ) const
          m_attributes.angularVelocity * crossProduct( relativePosition );
 }
 
-double CPhysicsObject::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
+void CPhysicsObject::sleep()
+{
+  m_sleeping = true;
+  m_attributes.velocity = {};
+  m_attributes.angularVelocity = 0;
+}
+
+void CPhysicsObject::wake()
+{
+  m_sleeping = false;
+  m_restFrames = 0;
+  m_restPosition = m_position;
+  m_restAngle = 0;
+}
+
+TScalar CPhysicsObject::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
 {
   if( m_tag & TRANSPARENT )
     return HUGE_VAL;
   return NAN;
 }
 
+TScalar CPhysicsObject::sweep( const CRectangle &, const TVector<2> &, TScalar ) const
+{
+  return HUGE_VAL;
+}
+
+TScalar CPhysicsObject::sweptBy( const CPhysicsObject &, const TVector<2> &, TScalar ) const
+{
+  return HUGE_VAL;
+}
+
 
-TContactPoint collision::circleCircle( const TVector<2> &firstCentre, double firstRadius,
-                                       const TVector<2> &secondCentre, double secondRadius )
+TContactPoint collision::circleCircle( const TVector<2> &firstCentre, TScalar firstRadius,
+                                       const TVector<2> &secondCentre, TScalar secondRadius )
 {
   TVector<2> relativePos = secondCentre - firstCentre;
-  double relativeDist = relativePos.norm();
-  double overlapSize = firstRadius + secondRadius - relativeDist;
+  TScalar relativeDist = relativePos.norm();
+  TScalar overlapSize = firstRadius + secondRadius - relativeDist;
   if( overlapSize <= 0 )
     return { {}, { NAN, NAN } };
   TVector<2> overlap = relativePos.stretchedTo( overlapSize / 2 );
@@ -77,26 +106,32 @@ TContactPoint collision::circleCircle( const TVector<2> &firstCentre, double fir
 
 TContactPoint collision::rectCircle( const TVector<2> &position,
                                      const TVector<2> &sizes,
-                                     double rotation,
+                                     TScalar rotation,
                                      const TVector<2> &centre,
-                                     double radius )
+                                     TScalar radius )
 {
-  TMatrix<2, 4> corners = rectCorners( position, sizes, rotation );
-  double smallestDist = HUGE_VAL;
+  return rectCircle( rectCorners( position, sizes, rotation ), centre, radius );
+}
+
+TContactPoint collision::rectCircle( const TMatrix<2, 4> &corners,
+                                     const TVector<2> &centre,
+                                     TScalar radius )
+{
+  TScalar smallestDist = HUGE_VAL;
   TVector<2> closestPoint;
   for( size_t idx = 0; idx < 4; ++idx )
   {
     TVector<2> temp = lineSegmentClosestPoint( corners[ idx ],
                                                corners[ ( idx + 1 ) % 4 ],
                                                centre );
-    double newDist = temp.squareDistance( centre );
+    TScalar newDist = temp.squareDistance( centre );
     if( newDist >= smallestDist )
       continue;
     smallestDist = newDist;
     closestPoint = temp;
   }
 
-  double distance = closestPoint.distance( centre );
+  TScalar distance = closestPoint.distance( centre );
   if( distance >= radius )
     return { {}, { NAN, NAN } };
 
@@ -105,21 +140,97 @@ TContactPoint collision::rectCircle( const TVector<2> &position,
   return { overlap, closestPoint - overlap };
 }
 
+TScalar collision::sweepCircleRect( const TVector<2> &start,
+                                   const TVector<2> &end,
+                                   TScalar radius,
+                                   const TVector<2> &position,
+                                   const TVector<2> &size,
+                                   TScalar rotation )
+{
+  // rectangle space
+  TVector<2> begin = ( start - position ).rotated( -rotation );
+  TVector<2> motion = ( end - start ).rotated( -rotation );
+
+  TVector<2> closest = { clamp( begin[ 0 ], -size[ 0 ], size[ 0 ] ),
+                         clamp( begin[ 1 ], -size[ 1 ], size[ 1 ] ) };
+  if( begin.squareDistance( closest ) < radius * radius )
+    return HUGE_VAL;
+
+  // rectangle extended by radius
+  TScalar entry = 0, exit = 1;
+  for( size_t axis = 0; axis < 2; ++axis )
+  {
+    TScalar extent = size[ axis ] + radius;
+    if( motion[ axis ] == 0 )
+    {
+      if( abs( begin[ axis ] ) > extent )
+        return HUGE_VAL;
+      continue;
+    }
+    entry = max( entry, ( -copysign( extent, motion[ axis ] ) - begin[ axis ] ) / motion[ axis ] );
+    exit = min( exit, ( copysign( extent, motion[ axis ] ) - begin[ axis ] ) / motion[ axis ] );
+    if( entry > exit )
+      return HUGE_VAL;
+  }
+
+  // corners of extended rectangle are rounded
+  TVector<2> hit = begin + motion * entry;
+  if( abs( hit[ 0 ] ) > size[ 0 ] && abs( hit[ 1 ] ) > size[ 1 ] )
+    return sweepCirclePoint( begin, motion,
+                             { copysign( size[ 0 ], hit[ 0 ] ), copysign( size[ 1 ], hit[ 1 ] ) },
+                             radius );
+  return entry;
+}
+
+TScalar collision::sweepCirclePoint( const TVector<2> &start,
+                                     const TVector<2> &motion,
+                                     const TVector<2> &point,
+                                     TScalar radius )
+{
+  TVector<2> relative = start - point;
+  TScalar a = motion.squareNorm();
+  TScalar b = relative.dot( motion );
+  TScalar c = relative.squareNorm() - radius * radius;
+  TScalar discriminant = b * b - a * c;
+  if( b >= 0 || discriminant < 0 )
+    return HUGE_VAL;
+  TScalar impact = ( -b - sqrt( discriminant ) ) / a;
+  return impact <= 1 ? impact : HUGE_VAL;
+}
+
+TRectangleShape::TRectangleShape( const TVector<2> &size, TScalar rotation )
+  : size( size ),
+    firstDiagonal( size.rotated( rotation ) ),
+    secondDiagonal{ size[ 0 ], -size[ 1 ] },
+    axes{ TVector<2>::canonical( 0 ).rotated( rotation ),
+          TVector<2>::canonical( 0 ).rotated( rotation + M_PI_2 ) }
+{
+  secondDiagonal.rotate( rotation );
+}
+
 TContactPoint collision::rectRect( const TVector<2> &firstPos,
                                    const TVector<2> &firstSize,
-                                   double firstRot,
+                                   TScalar firstRot,
                                    const TVector<2> &secondPos,
                                    const TVector<2> &secondSize,
-                                   double secondRot )
+                                   TScalar secondRot )
 {
   if( firstPos.distance( secondPos ) > firstSize.norm() + secondSize.norm() )
     return { {}, { NAN, NAN } };
+  return rectRect( firstPos, { firstSize, firstRot }, secondPos, { secondSize, secondRot } );
+}
+
+TContactPoint collision::rectRect( const TVector<2> &firstPos,
+                                   const TRectangleShape &firstShape,
+                                   const TVector<2> &secondPos,
+                                   const TRectangleShape &secondShape )
+{
+  if( firstPos.distance( secondPos ) > firstShape.size.norm() + secondShape.size.norm() )
+    return { {}, { NAN, NAN } };
   // vector needed to move first
-  TContactPoint firstSecond = firstRectOverlap( firstPos, firstSize, firstRot,
-                                                secondPos, secondSize, secondRot );
+  TContactPoint firstSecond = firstRectOverlap( firstPos, firstShape, secondPos, secondShape );
   // vector needed to move second
-  TContactPoint secondFirst = firstRectOverlap( secondPos, secondSize, secondRot,
-                                                firstPos, firstSize, firstRot );
+  TContactPoint secondFirst = firstRectOverlap( secondPos, secondShape, firstPos, firstShape );
   if( !firstSecond.contactPoint )
     return firstSecond;
   if( !secondFirst.contactPoint )
@@ -130,26 +241,22 @@ TContactPoint collision::rectRect( const TVector<2> &firstPos,
     return secondFirst;
 
   firstSecond.overlapVector *= -1;
+  firstSecond.feature += 16;
   return firstSecond;
 }
 
 TContactPoint collision::firstRectOverlap( const TVector<2> &firstPos,
-                                           const TVector<2> &firstSize,
-                                           double firstRot,
+                                           const TRectangleShape &firstShape,
                                            const TVector<2> &secondPos,
-                                           const TVector<2> &secondSize,
-                                           double secondRot )
+                                           const TRectangleShape &secondShape )
 {
-  TVector<2> axes[4] = {
-          TVector<2>::canonical( 0 ).rotated( firstRot ),
-          TVector<2>::canonical( 0 ).rotated( firstRot + M_PI_2 )
-  };
+  TVector<2> axes[4] = { firstShape.axes[ 0 ], firstShape.axes[ 1 ] };
   axes[ 2 ] = -axes[ 0 ];
   axes[ 3 ] = -axes[ 1 ];
-  TMatrix<2, 4> firstCorners = rectCorners( firstPos, firstSize, firstRot );
-  TMatrix<2, 4> secondCorners = rectCorners( secondPos, secondSize, secondRot );
+  TMatrix<2, 4> firstCorners = rectCorners( firstPos, firstShape );
+  TMatrix<2, 4> secondCorners = rectCorners( secondPos, secondShape );
 
-  double smallestOverlap = HUGE_VAL;
+  TScalar smallestOverlap = HUGE_VAL;
   TContactPoint res;
   for( size_t idx = 0; idx < 4; ++idx )
   {
@@ -158,11 +265,12 @@ TContactPoint collision::firstRectOverlap( const TVector<2> &firstPos,
                                                 secondCorners );
     if( !temp.overlapVector )
       return { {}, { NAN, NAN } };
-    double dist = temp.overlapVector.squareNorm();
+    TScalar dist = temp.overlapVector.squareNorm();
     if( dist < smallestOverlap )
     {
       smallestOverlap = dist;
       res = temp;
+      res.feature += idx * 4;
     }
   }
 
@@ -171,14 +279,18 @@ TContactPoint collision::firstRectOverlap( const TVector<2> &firstPos,
 
 TMatrix<2, 4> collision::rectCorners( const TVector<2> &position,
                                       const TVector<2> &size,
-                                      double rotation )
+                                      TScalar rotation )
 {
   TVector<2> firstDiagonal = size.rotated( rotation );
   TVector<2> secondDiagonal = size;
   secondDiagonal[ 1 ] *= -1;
   secondDiagonal.rotate( rotation );
-  return { position + firstDiagonal, position + secondDiagonal,
-           position - firstDiagonal, position - secondDiagonal };
+  return parallelogram( position, firstDiagonal, secondDiagonal );
+}
+
+TMatrix<2, 4> collision::rectCorners( const TVector<2> &position, const TRectangleShape &shape )
+{
+  return parallelogram( position, shape.firstDiagonal, shape.secondDiagonal );
 }
 
 template <size_t dim>
@@ -188,22 +300,24 @@ collision::axisPointsPenetration( const TVector<2> &axisDirection,
                                   const TMatrix<2, dim> &points )
 {
   TVector<2> normal = crossProduct( axisDirection ).normalized();
-  double maxOverlap = -HUGE_VAL;
+  TScalar maxOverlap = -HUGE_VAL;
   TVector<2> maxPoint;
+  size_t maxIdx = 0;
   for( size_t idx = 0; idx < dim; ++idx )
   {
     const TVector<2> &point = points[ idx ];
-    double projectionScale = normal.dot( point - axisPoint );
+    TScalar projectionScale = normal.dot( point - axisPoint );
     if( projectionScale <= maxOverlap )
       continue;
     maxOverlap = projectionScale;
     maxPoint = point;
+    maxIdx = idx;
   }
 
   if( maxOverlap <= 0 )
     return { {}, { NAN, NAN } };
 
-  return { normal.stretchedTo( maxOverlap / 2 ), maxPoint };
+  return { normal.stretchedTo( maxOverlap / 2 ), maxPoint, maxIdx };
 }
 
 TVector<2> collision::lineSegmentClosestPoint( const TVector<2> &begin,
@@ -211,7 +325,7 @@ TVector<2> collision::lineSegmentClosestPoint( const TVector<2> &begin,
                                                const TVector<2> &point )
 {
   TVector<2> direction = end - begin;
-  double projectionScale = direction.dot( point - begin ) / direction.squareNorm();
+  TScalar projectionScale = direction.dot( point - begin ) / direction.squareNorm();
   if( projectionScale <= 0 )
     return begin;
   if( projectionScale >= 1 )
@@ -219,10 +333,10 @@ TVector<2> collision::lineSegmentClosestPoint( const TVector<2> &begin,
   return begin + direction * projectionScale;
 }
 
-double collision::rayTraceLineSeg( const TVector<2> &position,
-                                   const TVector<2> &direction,
-                                   const TVector<2> &begin,
-                                   const TVector<2> &end )
+TScalar collision::rayTraceLineSeg( const TVector<2> &position,
+                                    const TVector<2> &direction,
+                                    const TVector<2> &begin,
+                                    const TVector<2> &end )
 {
   TVector<2> dir = direction.normalized();
   TMatrix<2, 2> mat = { dir, begin - end };
@@ -11,6 +11,20 @@ class CCircle;
 
 class CComplexObject;
 
+/**
+ * Concrete shape of physics object. Collision of two shapes is calculated
+ * by getManifold of object with larger shape type, other object forwards call to it.
+ */
+enum class EShapeType : uint8_t
+{
+  CIRCLE, RECTANGLE, COMPLEX
+};
+
+/**
+ * Number of shape types.
+ */
+constexpr size_t shapeTypeCount = 3;
+
 /**
  * Base class for all objects that are part of physics simulator.
  */
@@ -19,11 +33,13 @@ class CPhysicsObject : public CObject
 public:
   /**
    * Constructor.
+   * @param shapeType shape of derived class
    * @param position centre of mass position
    * @param attributes physics attributes
    * @param angle initial angle
    */
-  CPhysicsObject( TVector<2> position, const TPhysicsAttributes &attributes, double angle = 0 );
+  CPhysicsObject( EShapeType shapeType, TVector<2> position,
+                  const TPhysicsAttributes &attributes, TScalar angle = 0 );
 
   ~CPhysicsObject() override = default;
 
@@ -60,7 +76,7 @@ public:
    * @param angle
    * @return CPhysicsObject.
    */
-  virtual CPhysicsObject &rotate( double angle );
+  virtual CPhysicsObject &rotate( TScalar angle );
 
   /**
    * Ray cast against object. CPhysics object is abstract and
@@ -70,8 +86,33 @@ public:
    * @return HUGE_VAL if object is transparent
    * @return NAN otherwise
    */
-  [[nodiscard]] virtual double rayTrace( const TVector<2> &position,
-                                         const TVector<2> &direction ) const;
+  [[nodiscard]] virtual TScalar rayTrace( const TVector<2> &position,
+                                          const TVector<2> &direction ) const;
+
+  /**
+   * Calculates time of impact of this object moving from start pose to current pose
+   * with rectangle. Only circles and joints of complex objects are swept.
+   * @param rectangle obstacle
+   * @param startPosition position at start of step
+   * @param startRotation rotation at start of step
+   * @return Fraction of movement done before first touch,
+   * HUGE_VAL if object does not hit rectangle or already touched it at start.
+   */
+  [[nodiscard]] virtual TScalar sweep( const CRectangle &rectangle,
+                                       const TVector<2> &startPosition,
+                                       TScalar startRotation ) const;
+
+  /**
+   * Calculates time of impact of object moving from start pose to current pose with this object.
+   * Only rectangles are obstacles for continuous collision.
+   * @param object moving object
+   * @param startPosition position of object at start of step
+   * @param startRotation rotation of object at start of step
+   * @return Fraction of movement done before first touch, HUGE_VAL if there is no impact.
+   */
+  [[nodiscard]] virtual TScalar sweptBy( const CPhysicsObject &object,
+                                         const TVector<2> &startPosition,
+                                         TScalar startRotation ) const;
 
   /**
    * Resets all accumulators in object physics attributes.
@@ -79,17 +120,26 @@ public:
   void resetAccumulator();
 
   /**
-   * Applies accumulated forces and torques to object.
-   * @param dt time delta
+   * Applies impulse to object. Static objects ( zero inverse mass ) are not affected.
+   * @param impulse impulse
+   * @param point point of interaction.
    */
-  void applyForce( double dt );
+  void applyImpulse( const TVector<2> &impulse, const TVector<2> &point );
 
   /**
-   * Applies impulse to object.
+   * Changes velocity and angular velocity by impulse, object is not damaged.
+   * Static objects ( zero inverse mass ) are not affected.
    * @param impulse impulse
    * @param point point of interaction.
    */
-  void applyImpulse( const TVector<2> &impulse, const TVector<2> &point );
+  void applyVelocityImpulse( const TVector<2> &impulse, const TVector<2> &point );
+
+  /**
+   * Decreases integrity by damage caused by impulse received in collision.
+   * Static objects ( zero inverse mass ) are not affected.
+   * @param impulse
+   */
+  void applyDamage( const TVector<2> &impulse );
 
   /**
    * Calculates velocity ( translational + rotational ) of object at point.
@@ -98,6 +148,22 @@ public:
    */
   [[nodiscard]] TVector<2> getLocalVelocity( const TVector<2> &point ) const;
 
+  /**
+   * Puts object to sleep. Sleeping object is not moved by engine
+   * until woken, its velocity is zeroed.
+   */
+  void sleep();
+
+  /**
+   * Wakes object and restarts its resting.
+   */
+  void wake();
+
+  /**
+   * Shape of object, selects collision function without virtual calls.
+   */
+  const EShapeType m_shapeType;
+
   /**
    * Physics attributes of object.
    */
@@ -106,12 +172,65 @@ public:
   /**
    * Radius of bounding box centred at m_position.
    */
-  double m_boundingRadius = HUGE_VAL;
+  TScalar m_boundingRadius = HUGE_VAL;
 
   /**
    * Objects rotation.
    */
-  double m_rotation;
+  TScalar m_rotation;
+
+  /**
+   * True if object is sleeping.
+   */
+  bool m_sleeping = false;
+
+  /**
+   * Object is swept against rectangles, so it does not tunnel through them at high speed.
+   */
+  bool m_continuous = false;
+
+  /**
+   * Number of consecutive frames object stayed near m_restPosition.
+   */
+  size_t m_restFrames = 0;
+
+  /**
+   * Position at start of resting window.
+   */
+  TVector<2> m_restPosition;
+
+  /**
+   * Rotation done since start of resting window.
+   */
+  TScalar m_restAngle = 0;
+};
+
+/**
+ * Rectangle size with vectors depending on its rotation. Computed once per rotation,
+ * so collision tests and ray traces do not repeat trigonometry.
+ */
+struct TRectangleShape
+{
+  /**
+   * @param size vector from centre to top-right corner
+   * @param rotation
+   */
+  TRectangleShape( const TVector<2> &size, TScalar rotation );
+
+  /**
+   * Vector from centre to top-right corner.
+   */
+  TVector<2> size;
+
+  /**
+   * Size and size mirrored by x axis, rotated by rotation.
+   */
+  TVector<2> firstDiagonal, secondDiagonal;
+
+  /**
+   * Rotated x and y axis.
+   */
+  TVector<2> axes[ 2 ];
 };
 
 namespace collision
@@ -123,8 +242,8 @@ namespace collision
  * @param radiusA, radiusB radius of circle
  * @return TContactPoint between circles.
  */
-TContactPoint circleCircle( const TVector<2> &centreA, double radiusA,
-                            const TVector<2> &centreB, double radiusB );
+TContactPoint circleCircle( const TVector<2> &centreA, TScalar radiusA,
+                            const TVector<2> &centreB, TScalar radiusB );
 
 /**
  * Calculates collision information between rectangle and circle.
@@ -137,30 +256,82 @@ TContactPoint circleCircle( const TVector<2> &centreA, double radiusA,
  */
 TContactPoint rectCircle( const TVector<2> &position,
                           const TVector<2> &size,
-                          double rotation,
+                          TScalar rotation,
                           const TVector<2> &centre,
-                          double radius );
+                          TScalar radius );
+
+/**
+ * Calculates collision information between rectangle given by corners and circle.
+ * @param corners corners of rectangle in order around rectangle
+ * @param centre centre of circle
+ * @param radius circle radius
+ * @return TContactPoint between rectangle and circle.
+ */
+TContactPoint rectCircle( const TMatrix<2, 4> &corners,
+                          const TVector<2> &centre,
+                          TScalar radius );
+
+/**
+ * Calculates time of impact of moving circle with rectangle.
+ * @param start circle centre at start of movement
+ * @param end circle centre at end of movement
+ * @param radius circle radius
+ * @param position centre of rectangle
+ * @param size rectangle size
+ * @param rotation rectangle rotation
+ * @return Fraction of movement done before first touch,
+ * HUGE_VAL if circle does not hit rectangle or already touches it at start.
+ */
+TScalar sweepCircleRect( const TVector<2> &start,
+                         const TVector<2> &end,
+                         TScalar radius,
+                         const TVector<2> &position,
+                         const TVector<2> &size,
+                         TScalar rotation );
+
+/**
+ * Calculates time of impact of moving circle with point.
+ * @param start circle centre at start of movement
+ * @param motion movement of circle centre
+ * @param point
+ * @param radius circle radius
+ * @return Fraction of movement done before first touch, HUGE_VAL if circle does not hit point.
+ */
+TScalar sweepCirclePoint( const TVector<2> &start,
+                          const TVector<2> &motion,
+                          const TVector<2> &point,
+                          TScalar radius );
 
 /**
  * Calculates collision information between two rectangles.
+ * Feature of contact identifies penetrating corner and axis of separation.
  * @param positionA, positionB rectangle centre
  * @param sizeA, sizeB rectangle size
  * @param rotationA, rotationB rectangle rotation
  * @return TContactPoint between two rectangles.
  */
-TContactPoint rectRect( const TVector<2> &positionA, const TVector<2> &sizeA, double rotationA,
-                        const TVector<2> &positionB, const TVector<2> &sizeB, double rotationB );
+TContactPoint rectRect( const TVector<2> &positionA, const TVector<2> &sizeA, TScalar rotationA,
+                        const TVector<2> &positionB, const TVector<2> &sizeB, TScalar rotationB );
+
+/**
+ * Calculates collision information between two rectangles.
+ * Feature of contact identifies penetrating corner and axis of separation.
+ * @param positionA, positionB rectangle centre
+ * @param shapeA, shapeB rectangle shape
+ * @return TContactPoint between two rectangles.
+ */
+TContactPoint rectRect( const TVector<2> &positionA, const TRectangleShape &shapeA,
+                        const TVector<2> &positionB, const TRectangleShape &shapeB );
 
 /**
  * Calculates collision information between two rectangles.
  * Collision overlap is calculated only in direction parallel to first rectangle sides.
  * @param positionA, positionB rectangle centre
- * @param sizeA, sizeB rectangle size
- * @param rotationA, rotationB rectangle rotation
+ * @param shapeA, shapeB rectangle shape
  * @return TContactPoint between two rectangles.
  */
-TContactPoint firstRectOverlap( const TVector<2> &positionA, const TVector<2> &sizeA, double rotationA,
-                                const TVector<2> &positionB, const TVector<2> &sizeB, double rotationB );
+TContactPoint firstRectOverlap( const TVector<2> &positionA, const TRectangleShape &shapeA,
+                                const TVector<2> &positionB, const TRectangleShape &shapeB );
 
 /**
  * @param position rectangle centre
@@ -168,7 +339,14 @@ TContactPoint firstRectOverlap( const TVector<2> &positionA, const TVector<2> &s
  * @param rotation rectangle rotation
  * @return Matrix of rectangle corners from top-right clockwise.
  */
-TMatrix<2, 4> rectCorners( const TVector<2> &position, const TVector<2> &size, double rotation );
+TMatrix<2, 4> rectCorners( const TVector<2> &position, const TVector<2> &size, TScalar rotation );
+
+/**
+ * @param position rectangle centre
+ * @param shape rectangle shape
+ * @return Matrix of rectangle corners from top-right clockwise.
+ */
+TMatrix<2, 4> rectCorners( const TVector<2> &position, const TRectangleShape &shape );
 
 /**
  * Calculates most-left overlap of points through axis.
@@ -176,7 +354,7 @@ TMatrix<2, 4> rectCorners( const TVector<2> &position, const TVector<2> &size, d
  * @param axisDirection direction of axis
  * @param axisPoint any point on axis
  * @param points points
- * @return Overlap of most-left point.
+ * @return Overlap of most-left point, feature is index of point.
  */
 template <size_t dim>
 TContactPoint axisPointsPenetration( const TVector<2> &axisDirection,
@@ -204,9 +382,9 @@ TVector<2> lineSegmentClosestPoint( const TVector<2> &begin,
  * Negative number if ray hits segment in opposite direction.
  * HUGE_VAL if ray never hits line segment.
  */
-double rayTraceLineSeg( const TVector<2> &position,
-                        const TVector<2> &direction,
-                        const TVector<2> &begin,
-                        const TVector<2> &end );
+TScalar rayTraceLineSeg( const TVector<2> &position,
+                         const TVector<2> &direction,
+                         const TVector<2> &begin,
+                         const TVector<2> &end );
 
 } // namespace collision
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "physicsProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+using namespace std;
+
+#ifdef PHYSICS_PROFILING
+
+double TStepStatistics::total() const
+{
+  return accumulateForces + applyForces +
+         search[ 0 ].time + search[ 1 ].time +
+         impulses + resolution;
+}
+
+CStepHistogram::CStepHistogram( size_t capacity )
+  : m_capacity( max( capacity, (size_t)1 ) )
+{
+  m_samples.reserve( m_capacity );
+}
+
+void CStepHistogram::add( double stepTime )
+{
+  if( m_samples.size() < m_capacity )
+    m_samples.push_back( stepTime );
+  else
+  {
+    --m_buckets[ bucketIndex( m_samples[ m_next ] ) ];
+    m_samples[ m_next ] = stepTime;
+  }
+  ++m_buckets[ bucketIndex( stepTime ) ];
+  m_next = ( m_next + 1 ) % m_capacity;
+}
+
+void CStepHistogram::clear()
+{
+  m_samples.clear();
+  m_next = 0;
+  m_buckets = {};
+}
+
+const array<size_t, CStepHistogram::bucketCount> &CStepHistogram::buckets() const
+{
+  return m_buckets;
+}
+
+size_t CStepHistogram::size() const
+{
+  return m_samples.size();
+}
+
+double CStepHistogram::percentile( double fraction ) const
+{
+  if( m_samples.empty() )
+    return 0;
+  vector<double> sorted = m_samples;
+  auto nth = sorted.begin() + (ptrdiff_t)( clamp( fraction, 0., 1. ) * (double)( sorted.size() - 1 ) );
+  nth_element( sorted.begin(), nth, sorted.end() );
+  return *nth;
+}
+
+double CStepHistogram::bucketUpperBound( size_t bucket )
+{
+  if( bucket + 1 >= bucketCount )
+    return HUGE_VAL;
+  return ldexp( 1e-6, (int)bucket );
+}
+
+size_t CStepHistogram::bucketIndex( double stepTime )
+{
+  size_t bucket = 0;
+  while( bucket + 1 < bucketCount && stepTime >= bucketUpperBound( bucket ) )
+    ++bucket;
+  return bucket;
+}
+
+CPhaseClock::CPhaseClock()
+  : m_phaseStart( chrono::steady_clock::now() )
+{}
+
+double CPhaseClock::lap()
+{
+  auto now = chrono::steady_clock::now();
+  double length = chrono::duration<double>( now - m_phaseStart ).count();
+  m_phaseStart = now;
+  return length;
+}
+#endif
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * Physics profiling is compiled in only with PHYSICS_PROFILING defined. ( make PROFILE=1 )
+ * Otherwise statements wrapped in PHYSICS_PROFILE are removed and profiling types do not exist.
+ */
+#ifdef PHYSICS_PROFILING
+#define PHYSICS_PROFILE( ... ) __VA_ARGS__
+#else
+#define PHYSICS_PROFILE( ... )
+#endif
+
+#ifdef PHYSICS_PROFILING
+
+
+/**
+ * Time and counters of single collision search pass.
+ */
+struct TSearchStatistics
+{
+  /**
+   * Time spent in search, broad-phase included. In seconds.
+   */
+  double time = 0;
+
+  /**
+   * Number of pairs passed from broad-phase to exact test.
+   */
+  size_t pairTests = 0;
+
+  /**
+   * Number of pairs that really collide.
+   */
+  size_t manifolds = 0;
+};
+
+/**
+ * Time spent in phases of single step and number of found collisions.
+ * Times are in seconds.
+ */
+struct TStepStatistics
+{
+  /**
+   * @return Time of whole step.
+   */
+  [[nodiscard]] double total() const;
+
+  /**
+   * Force accumulation from fields.
+   */
+  double accumulateForces = 0;
+
+  /**
+   * Integration of forces.
+   */
+  double applyForces = 0;
+
+  /**
+   * Collision search before impulses and collision searches of all position iterations together.
+   */
+  std::array<TSearchStatistics, 2> search;
+
+  /**
+   * Impulse application.
+   */
+  double impulses = 0;
+
+  /**
+   * Positional collision resolution, both passes.
+   */
+  double resolution = 0;
+
+  /**
+   * Number of contact points in all manifolds.
+   */
+  size_t contacts = 0;
+};
+
+/**
+ * Histogram of step times over last capacity steps.
+ * Bucket 0 holds steps under 1 us, bucket n steps in [ 2^(n-1), 2^n ) us,
+ * last bucket holds everything longer.
+ */
+class CStepHistogram
+{
+public:
+  /**
+   * Number of histogram buckets.
+   */
+  static const size_t bucketCount = 20;
+
+  /**
+   * Creates histogram rolling over capacity steps.
+   * @param capacity
+   */
+  explicit CStepHistogram( size_t capacity = 256 );
+
+  /**
+   * Adds step time, oldest step is forgotten if histogram is full.
+   * @param stepTime time in seconds
+   */
+  void add( double stepTime );
+
+  /**
+   * Forgets all steps.
+   */
+  void clear();
+
+  /**
+   * @return Step counts in buckets.
+   */
+  [[nodiscard]] const std::array<size_t, bucketCount> &buckets() const;
+
+  /**
+   * @return Number of steps in histogram.
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * @param fraction value in [ 0, 1 ]
+   * @return Step time in seconds not exceeded by fraction of steps.
+   */
+  [[nodiscard]] double percentile( double fraction ) const;
+
+  /**
+   * @param bucket
+   * @return Upper bound of bucket in seconds.
+   */
+  static double bucketUpperBound( size_t bucket );
+
+private:
+  /**
+   * @param stepTime
+   * @return Bucket of step time.
+   */
+  static size_t bucketIndex( double stepTime );
+
+  /**
+   * Ring buffer of step times.
+   */
+  std::vector<double> m_samples;
+
+  /**
+   * Ring buffer capacity.
+   */
+  size_t m_capacity;
+
+  /**
+   * Position of next write to ring buffer.
+   */
+  size_t m_next = 0;
+
+  /**
+   * Step counts in buckets.
+   */
+  std::array<size_t, bucketCount> m_buckets{};
+};
+
+/**
+ * Stopwatch measuring consecutive phases.
+ */
+class CPhaseClock
+{
+public:
+  /**
+   * Starts measuring first phase.
+   */
+  CPhaseClock();
+
+  /**
+   * Ends phase and starts next one.
+   * @return Length of ended phase in seconds.
+   */
+  double lap();
+
+private:
+  /**
+   * Start of current phase.
+   */
+  std::chrono::steady_clock::time_point m_phaseStart;
+};
+#endif
@@ -0,0 +1,184 @@
+#include "rayCaster.hpp"
+#include <algorithm>
+
+
+using namespace std;
+
+const size_t CRayCaster::maxCells = 1 << 14;
+const size_t CRayCaster::maxObjectCells = 64;
+
+/**
+ * Margin added to bounding circles, exact ray trace may round outside of them.
+ */
+static const TScalar circleMargin = 1e-6;
+
+CRayCaster::CRayCaster( TScalar cellSize )
+  : m_cellSize( cellSize )
+{}
+
+void CRayCaster::build( const vector<CPhysicsObject *> &objects )
+{
+  m_objects = objects;
+  m_large.clear();
+  m_cellStart.clear();
+  m_cellObjects.clear();
+  m_columns = m_rows = 0;
+
+  vector<size_t> gridded;
+  TBoundingBox bounds{ { HUGE_VAL, HUGE_VAL }, { -HUGE_VAL, -HUGE_VAL } };
+  for( size_t idx = 0; idx < objects.size(); ++idx )
+  {
+    const auto &object = *objects[ idx ];
+    if( object.m_tag & ETag::TRANSPARENT )
+      continue;
+    if( !isfinite( object.m_boundingRadius ) ||
+        !isfinite( object.m_position[ 0 ] ) || !isfinite( object.m_position[ 1 ] ) )
+    {
+      m_large.push_back( idx );
+      continue;
+    }
+    gridded.push_back( idx );
+    bounds.merge( TBoundingBox::around( object.m_position, object.m_boundingRadius ) );
+  }
+  if( gridded.empty() )
+    return;
+
+  TVector<2> size = bounds.max - bounds.min;
+  if( !isfinite( size[ 0 ] ) || !isfinite( size[ 1 ] ) )
+  {
+    m_large.insert( m_large.end(), gridded.begin(), gridded.end() );
+    sort( m_large.begin(), m_large.end() );
+    return;
+  }
+  m_origin = bounds.min;
+  m_gridCellSize = m_cellSize;
+  while( ( floor( size[ 0 ] / m_gridCellSize ) + 1 ) * ( floor( size[ 1 ] / m_gridCellSize ) + 1 ) >
+         (TScalar)maxCells )
+    m_gridCellSize *= 2;
+  m_columns = (size_t)floor( size[ 0 ] / m_gridCellSize ) + 1;
+  m_rows = (size_t)floor( size[ 1 ] / m_gridCellSize ) + 1;
+
+  // objects are counted per cell first, then stored to cells in ascending order
+  m_cellStart.assign( m_columns * m_rows + 1, 0 );
+  for( size_t pass = 0; pass < 2; ++pass )
+  {
+    vector<size_t> fill( m_cellStart.begin(), m_cellStart.end() - 1 );
+    for( size_t idx: gridded )
+    {
+      const auto &object = *objects[ idx ];
+      TVector<2> extent{ object.m_boundingRadius, object.m_boundingRadius };
+      auto [ left, bottom ] = cell( object.m_position - extent );
+      auto [ right, top ] = cell( object.m_position + extent );
+      if( ( right - left + 1 ) * ( top - bottom + 1 ) > maxObjectCells )
+      {
+        if( pass == 0 )
+          m_large.push_back( idx );
+        continue;
+      }
+      for( size_t row = bottom; row <= top; ++row )
+        for( size_t column = left; column <= right; ++column )
+        {
+          if( pass == 0 )
+            ++m_cellStart[ row * m_columns + column + 1 ];
+          else
+            m_cellObjects[ fill[ row * m_columns + column ]++ ] = idx;
+        }
+    }
+    if( pass == 0 )
+    {
+      for( size_t idx = 1; idx < m_cellStart.size(); ++idx )
+        m_cellStart[ idx ] += m_cellStart[ idx - 1 ];
+      m_cellObjects.resize( m_cellStart.back() );
+    }
+  }
+  sort( m_large.begin(), m_large.end() );
+}
+
+TRayHit CRayCaster::nearest( const TRay &ray, TScalar maxDistance, const CPhysicsObject *ignored ) const
+{
+  return nearest( vector<TRay>{ ray }, maxDistance, ignored ).front();
+}
+
+vector<TRayHit> CRayCaster::nearest( const vector<TRay> &rays, TScalar maxDistance,
+                                     const CPhysicsObject *ignored ) const
+{
+  vector<size_t> objects = candidates( rays, maxDistance );
+  vector<TRayHit> result( rays.size() );
+  for( size_t rayIdx = 0; rayIdx < rays.size(); ++rayIdx )
+  {
+    const auto &ray = rays[ rayIdx ];
+    for( size_t idx: objects )
+    {
+      CPhysicsObject *object = m_objects[ idx ];
+      if( object == ignored || !nearRay( ray, maxDistance, *object ) )
+        continue;
+      TScalar distance = object->rayTrace( ray.origin, ray.direction );
+      if( distance < result[ rayIdx ].distance )
+        result[ rayIdx ] = { object, distance };
+    }
+  }
+  return result;
+}
+
+vector<TRayHit> CRayCaster::hits( const TRay &ray, TScalar maxDistance ) const
+{
+  vector<TRayHit> result;
+  for( size_t idx: candidates( { ray }, maxDistance ) )
+  {
+    CPhysicsObject *object = m_objects[ idx ];
+    if( !nearRay( ray, maxDistance, *object ) )
+      continue;
+    TScalar distance = object->rayTrace( ray.origin, ray.direction );
+    if( distance > maxDistance )
+      continue;
+    result.push_back( { object, distance } );
+  }
+  return result;
+}
+
+vector<size_t> CRayCaster::candidates( const vector<TRay> &rays, TScalar maxDistance ) const
+{
+  vector<size_t> result = m_large;
+  if( m_columns && !rays.empty() )
+  {
+    size_t left = 0, bottom = 0, right = m_columns - 1, top = m_rows - 1;
+    if( isfinite( maxDistance ) )
+    {
+      TBoundingBox area{ rays.front().origin, rays.front().origin };
+      for( const auto &ray: rays )
+      {
+        TVector<2> end = ray.origin + ray.direction.normalized() * maxDistance;
+        area.merge( { ray.origin, ray.origin } );
+        area.merge( { end, end } );
+      }
+      tie( left, bottom ) = cell( area.min );
+      tie( right, top ) = cell( area.max );
+    }
+    for( size_t row = bottom; row <= top; ++row )
+    {
+      size_t first = row * m_columns + left;
+      size_t last = row * m_columns + right + 1;
+      result.insert( result.end(),
+                     m_cellObjects.begin() + (long)m_cellStart[ first ],
+                     m_cellObjects.begin() + (long)m_cellStart[ last ] );
+    }
+  }
+  sort( result.begin(), result.end() );
+  result.erase( unique( result.begin(), result.end() ), result.end() );
+  return result;
+}
+
+bool CRayCaster::nearRay( const TRay &ray, TScalar maxDistance, const CPhysicsObject &object )
+{
+  TVector<2> unit = ray.direction.normalized();
+  TScalar along = clamp<TScalar>( unit.dot( object.m_position - ray.origin ), 0, maxDistance );
+  TScalar radius = object.m_boundingRadius + circleMargin;
+  return !( ( ray.origin + unit * along ).squareDistance( object.m_position ) > radius * radius );
+}
+
+pair<size_t, size_t> CRayCaster::cell( const TVector<2> &point ) const
+{
+  TVector<2> relative = ( point - m_origin ) / m_gridCellSize;
+  return { (size_t)clamp<TScalar>( floor( relative[ 0 ] ), 0, (TScalar)m_columns - 1 ),
+           (size_t)clamp<TScalar>( floor( relative[ 1 ] ), 0, (TScalar)m_rows - 1 ) };
+}
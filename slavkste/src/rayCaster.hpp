@@ -0,0 +1,141 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include "segmentTree.hpp"
+#include <vector>
+
+
+/**
+ * Ray with origin and direction.
+ */
+struct TRay
+{
+  TVector<2> origin;
+  TVector<2> direction;
+};
+
+/**
+ * Object hit by ray and distance of hit from ray origin.
+ */
+struct TRayHit
+{
+  CPhysicsObject *object = nullptr;
+  TScalar distance = HUGE_VAL;
+};
+
+/**
+ * Scene query for ray casts. Bounding circles of objects are stored in uniform grid,
+ * only objects whose bounding circle is near ray are ray traced.
+ * Objects must not move or be deleted until next build.
+ */
+class CRayCaster
+{
+public:
+  /**
+   * @param cellSize side of grid cell
+   */
+  explicit CRayCaster( TScalar cellSize = 64 );
+
+  /**
+   * Stores objects to grid. Transparent objects are never hit and are left out.
+   * @param objects
+   */
+  void build( const std::vector<CPhysicsObject *> &objects );
+
+  /**
+   * Finds nearest object hit by ray. Objects not hit within maxDistance may be ignored.
+   * @param ray
+   * @param maxDistance
+   * @param ignored object which is not tested, may be null
+   * @return Nearest hit, without object if nothing is hit.
+   */
+  [[nodiscard]] TRayHit nearest( const TRay &ray, TScalar maxDistance,
+                                 const CPhysicsObject *ignored = nullptr ) const;
+
+  /**
+   * Finds nearest hit of each ray. Candidates are gathered once for all rays,
+   * so rays should be close to each other.
+   * @param rays
+   * @param maxDistance
+   * @param ignored object which is not tested, may be null
+   * @return Nearest hit of each ray.
+   */
+  [[nodiscard]] std::vector<TRayHit> nearest( const std::vector<TRay> &rays, TScalar maxDistance,
+                                              const CPhysicsObject *ignored = nullptr ) const;
+
+  /**
+   * Finds all objects hit by ray within maxDistance.
+   * @param ray
+   * @param maxDistance
+   * @return Hits in order of objects given to build.
+   */
+  [[nodiscard]] std::vector<TRayHit> hits( const TRay &ray, TScalar maxDistance ) const;
+
+private:
+  /**
+   * Finds objects whose bounding circle may be hit by rays within maxDistance.
+   * @param rays
+   * @param maxDistance
+   * @return Ascending object indices.
+   */
+  [[nodiscard]] std::vector<size_t> candidates( const std::vector<TRay> &rays, TScalar maxDistance ) const;
+
+  /**
+   * @param ray
+   * @param maxDistance
+   * @param object
+   * @return True if ray within maxDistance passes through bounding circle of object.
+   */
+  static bool nearRay( const TRay &ray, TScalar maxDistance, const CPhysicsObject &object );
+
+  /**
+   * @param point
+   * @return Cell coordinates of point, clamped to grid.
+   */
+  [[nodiscard]] std::pair<size_t, size_t> cell( const TVector<2> &point ) const;
+
+  /**
+   * Largest number of cells in grid.
+   */
+  static const size_t maxCells;
+
+  /**
+   * Objects covering more cells are tested with every ray.
+   */
+  static const size_t maxObjectCells;
+
+  /**
+   * Side of grid cell.
+   */
+  TScalar m_cellSize;
+
+  /**
+   * Side of grid cell used by last build, grows if grid would have too many cells.
+   */
+  TScalar m_gridCellSize = 0;
+
+  /**
+   * Objects given to build.
+   */
+  std::vector<CPhysicsObject *> m_objects;
+
+  /**
+   * Bottom-left corner of grid.
+   */
+  TVector<2> m_origin;
+
+  /**
+   * Grid size in cells.
+   */
+  size_t m_columns = 0, m_rows = 0;
+
+  /**
+   * Objects of cell idx are m_cellObjects[ m_cellStart[ idx ] .. m_cellStart[ idx + 1 ] ).
+   */
+  std::vector<size_t> m_cellStart, m_cellObjects;
+
+  /**
+   * Objects tested with every ray.
+   */
+  std::vector<size_t> m_large;
+};
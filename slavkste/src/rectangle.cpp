@@ -8,12 +8,14 @@ using namespace collision;
 
 CRectangle::CRectangle( TVector<2> centrePoint,
                         TVector<2> size,
-                        double rotation, double density )
-  : CPhysicsObject( centrePoint,
+                        TScalar rotation, TScalar density )
+  : CPhysicsObject( EShapeType::RECTANGLE,
+                    centrePoint,
                     TPhysicsAttributes::rectangleAttributes( density,
                                                              size ),
                     rotation ),
-    m_size{ size / 2 }
+    m_size{ size / 2 },
+    m_shape( m_size, rotation )
 {
   m_boundingRadius = m_size.norm();
 }
@@ -30,15 +32,13 @@ TManifold CRectangle::getManifold( CPhysicsObject *other )
 
 TManifold CRectangle::getManifold( CRectangle *other )
 {
-  TContactPoint contact = rectRect( m_position, m_size, m_rotation,
-                                    other->m_position, other->m_size, other->m_rotation );
+  TContactPoint contact = rectRect( m_position, m_shape, other->m_position, other->m_shape );
   return { this, other, contact };
 }
 
 TManifold CRectangle::getManifold( CCircle *circle )
 {
-  TContactPoint contact = rectCircle( m_position, m_size, m_rotation,
-                                      circle->m_position, circle->m_radius );
+  TContactPoint contact = rectCircle( corners(), circle->m_position, circle->m_radius );
   return { this, circle, contact };
 }
 
@@ -47,50 +47,53 @@ TManifold CRectangle::getManifold( CComplexObject *other )
   return other->getManifold( this );
 }
 
-CPhysicsObject &CRectangle::rotate( double angle )
+CPhysicsObject &CRectangle::rotate( TScalar angle )
 {
-  return CPhysicsObject::rotate( angle );
+  CPhysicsObject::rotate( angle );
+  m_shape = { m_size, m_rotation };
+  return *this;
+}
+
+TScalar CRectangle::sweptBy( const CPhysicsObject &object,
+                             const TVector<2> &startPosition,
+                             TScalar startRotation ) const
+{
+  return object.sweep( *this, startPosition, startRotation );
 }
 
 TVector<2> CRectangle::left() const
 {
-  TVector<2> dir = m_size;
-  dir[ 1 ] = 0;
-  dir.rotate( m_rotation );
-  return m_position - dir;
+  return m_position - m_shape.axes[ 0 ] * m_size[ 0 ];
 }
 
 TVector<2> CRectangle::right() const
 {
-  TVector<2> dir = m_size;
-  dir[ 1 ] = 0;
-  dir.rotate( m_rotation );
-  return m_position + dir;
+  return m_position + m_shape.axes[ 0 ] * m_size[ 0 ];
 }
 
 TMatrix<2, 4> CRectangle::corners() const
 {
-  return rectCorners( m_position, m_size, m_rotation );
+  return rectCorners( m_position, m_shape );
 }
 
-double CRectangle::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
+TScalar CRectangle::rayTrace( const TVector<2> &position, const TVector<2> &direction ) const
 {
   if( CPhysicsObject::rayTrace( position, direction ) == HUGE_VAL )
     return HUGE_VAL;
   return rayTrace( position, direction, corners() );
 }
 
-double CRectangle::rayTrace( const TVector<2> &position,
-                             const TVector<2> &direction,
-                             const TMatrix<2, 4> &rectCorners )
+TScalar CRectangle::rayTrace( const TVector<2> &position,
+                              const TVector<2> &direction,
+                              const TMatrix<2, 4> &rectCorners )
 {
-  double min = HUGE_VAL;
+  TScalar min = HUGE_VAL;
   bool negative = false;
   for( size_t idx = 0; idx < 4; ++idx )
   {
-    double rayLen = rayTraceLineSeg( position, direction,
-                                     rectCorners[ idx ],
-                                     rectCorners[ ( idx + 1 ) % 4 ] );
+    TScalar rayLen = rayTraceLineSeg( position, direction,
+                                      rectCorners[ idx ],
+                                      rectCorners[ ( idx + 1 ) % 4 ] );
     if( rayLen <= 0 )
       negative = true;
     else if( rayLen < min )
@@ -17,8 +17,8 @@ public:
    */
   CRectangle( TVector<2> centrePoint,
               TVector<2> size,
-              double rotation,
-              double density );
+              TScalar rotation,
+              TScalar density );
 
   /**
    * Renders rectangle to window.
@@ -31,7 +31,7 @@ public:
    * @param angle angle to rotate object
    * @return CPhysicsObject instance.
    */
-  CPhysicsObject &rotate( double angle ) override;
+  CPhysicsObject &rotate( TScalar angle ) override;
 
   /**
    * Calculates collision manifold with other object.
@@ -65,10 +65,21 @@ public:
    * Calculates largest distance ray can travel from position in direction.
    * @param position
    * @param direction
-   * @return Non-negative double.
+   * @return Non-negative scalar.
    */
-  [[nodiscard]] double rayTrace( const TVector<2> &position,
-                                 const TVector<2> &direction ) const override;
+  [[nodiscard]] TScalar rayTrace( const TVector<2> &position,
+                                  const TVector<2> &direction ) const override;
+
+  /**
+   * Calculates time of impact of object moving from start pose to current pose with rectangle.
+   * @param object moving object
+   * @param startPosition position of object at start of step
+   * @param startRotation rotation of object at start of step
+   * @return Fraction of movement done before first touch, HUGE_VAL if there is no impact.
+   */
+  [[nodiscard]] TScalar sweptBy( const CPhysicsObject &object,
+                                 const TVector<2> &startPosition,
+                                 TScalar startRotation ) const override;
 
    /**
     * Calculates largest distance ray can travel from position in direction,
@@ -78,9 +89,9 @@ public:
     * @param rectCorners
     * @return
     */
-  static double rayTrace( const TVector<2> &position,
-                          const TVector<2> &direction,
-                          const TMatrix<2, 4> &rectCorners );
+  static TScalar rayTrace( const TVector<2> &position,
+                           const TVector<2> &direction,
+                           const TMatrix<2, 4> &rectCorners );
 
   /**
    * @return Left-most point.
@@ -102,6 +113,11 @@ public:
    * vector from object centre to top-right corner
    */
   TVector<2> m_size;
+
+  /**
+   * Size with rotated diagonals and axes, updated by rotate.
+   */
+  TRectangleShape m_shape;
 };
 
 
@@ -0,0 +1,47 @@
+#include "renderer.hpp"
+
+
+using namespace std;
+
+TPen TPen::of( ETag tags )
+{
+  TPen pen;
+
+  if( tags & ETag::TRANSPARENT )
+  {
+    pen.a = 0.3;
+    pen.depth += 0.1;
+  }
+
+  if( tags & ETag::NON_SOLID )
+  {
+    pen.r = 0.1;
+    pen.g = 0.1;
+    pen.b = 0.8;
+    pen.a = 0.3;
+    pen.depth -= 0.2;
+  }
+
+  if( tags & ETag::TARGET )
+  {
+    pen.r = 0.1;
+    pen.g = 0.9;
+    pen.b = 0.1;
+  }
+
+  if( tags & ETag::PLAYER )
+  {
+    pen.r = 0.9;
+    pen.g = 0.1;
+    pen.b = 0.9;
+  }
+
+  if( tags & ETag::HEALTH )
+  {
+    pen.r = 0.9;
+    pen.g = 0.1;
+    pen.b = 0.1;
+  }
+
+  return pen;
+}
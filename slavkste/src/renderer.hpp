@@ -0,0 +1,73 @@
+#pragma once
+
+#include "linearAlgebra.hpp"
+#include "tags.hpp"
+#include <vector>
+#include <string>
+
+/**
+ * Colour and depth of drawing.
+ */
+struct TPen
+{
+  /**
+   * Colour components in range 0 - 1.
+   */
+  double r = 1, g = 1, b = 1, a = 1;
+
+  /**
+   * Drawing with larger depth covers drawing with smaller depth,
+   * of drawings with same depth first one is visible.
+   */
+  double depth = 0;
+
+  /**
+   * @param tags
+   * @return Pen of objects with tags.
+   */
+  static TPen of( ETag tags );
+};
+
+/**
+ * Backend drawing frames of CWindow.
+ */
+class CRenderer
+{
+public:
+  virtual ~CRenderer() = default;
+
+  /**
+   * Sets area of scene shown in viewport.
+   * @param viewOrigin bottom-left of scene area
+   * @param viewExtreme top-right of scene area
+   * @param viewportOrigin bottom-left of viewport in pixels
+   * @param scale pixels per scene unit
+   */
+  virtual void setView( const TVector<2> &viewOrigin, const TVector<2> &viewExtreme,
+                        const TVector<2> &viewportOrigin, double scale ) = 0;
+
+  /**
+   * Starts new frame with black background.
+   */
+  virtual void clear() = 0;
+
+  /**
+   * Draws triangles.
+   * @param vertices x, y pairs of triangle corners in scene coordinates
+   * @param pen
+   */
+  virtual void drawTriangles( const std::vector<float> &vertices, const TPen &pen ) = 0;
+
+  /**
+   * Draws text, center alignment.
+   * @param position scene coordinates of baseline center
+   * @param text
+   * @param pen
+   */
+  virtual void drawText( const TVector<2> &position, const std::string &text, const TPen &pen ) = 0;
+
+  /**
+   * Finishes frame.
+   */
+  virtual void present() = 0;
+};
@@ -0,0 +1,153 @@
+#include "segmentTree.hpp"
+
+
+using namespace std;
+
+const size_t CSegmentTree::leafSize = 4;
+
+/**
+ * Margin added to boxes, exact tests may round outside of box.
+ */
+static const TScalar boxMargin = 1e-6;
+
+TBoundingBox TBoundingBox::around( const TVector<2> &centre, TScalar radius )
+{
+  TVector<2> extent{ radius, radius };
+  return { centre - extent, centre + extent };
+}
+
+TBoundingBox TBoundingBox::around( const TMatrix<2, 4> &points )
+{
+  TBoundingBox box{ points[ 0 ], points[ 0 ] };
+  for( size_t idx = 1; idx < 4; ++idx )
+    box.merge( { points[ idx ], points[ idx ] } );
+  return box;
+}
+
+void TBoundingBox::merge( const TBoundingBox &other )
+{
+  for( size_t axis = 0; axis < 2; ++axis )
+  {
+    min[ axis ] = std::min( min[ axis ], other.min[ axis ] );
+    max[ axis ] = std::max( max[ axis ], other.max[ axis ] );
+  }
+}
+
+bool TBoundingBox::overlaps( const TBoundingBox &other ) const
+{
+  return min[ 0 ] <= other.max[ 0 ] && other.min[ 0 ] <= max[ 0 ] &&
+         min[ 1 ] <= other.max[ 1 ] && other.min[ 1 ] <= max[ 1 ];
+}
+
+bool TBoundingBox::hitBy( const TVector<2> &position, const TVector<2> &direction ) const
+{
+  TScalar entry = 0, exit = HUGE_VAL;
+  for( size_t axis = 0; axis < 2; ++axis )
+  {
+    if( direction[ axis ] == 0 )
+    {
+      if( position[ axis ] < min[ axis ] || position[ axis ] > max[ axis ] )
+        return false;
+      continue;
+    }
+    TScalar first = ( min[ axis ] - position[ axis ] ) / direction[ axis ];
+    TScalar second = ( max[ axis ] - position[ axis ] ) / direction[ axis ];
+    entry = std::max( entry, std::min( first, second ) );
+    exit = std::min( exit, std::max( first, second ) );
+  }
+  return entry <= exit;
+}
+
+
+void CSegmentTree::build( const vector<TVector<2>> &vertices, TScalar radius )
+{
+  m_radius = radius + boxMargin;
+  m_nodes.clear();
+  m_segments.resize( vertices.size() > 1 ? vertices.size() - 1 : 0 );
+  if( m_segments.empty() )
+    return;
+  build( 0, m_segments.size() );
+  refit( vertices );
+}
+
+size_t CSegmentTree::build( size_t begin, size_t end )
+{
+  size_t nodeIdx = m_nodes.size();
+  m_nodes.push_back( { {}, begin, end } );
+  if( end - begin <= leafSize )
+    return nodeIdx;
+  size_t middle = begin + ( end - begin ) / 2;
+  size_t left = build( begin, middle );
+  size_t right = build( middle, end );
+  m_nodes[ nodeIdx ].left = left;
+  m_nodes[ nodeIdx ].right = right;
+  return nodeIdx;
+}
+
+void CSegmentTree::refit( const vector<TVector<2>> &vertices )
+{
+  for( size_t idx = 0; idx < m_segments.size(); ++idx )
+  {
+    m_segments[ idx ] = TBoundingBox::around( vertices[ idx ], m_radius );
+    m_segments[ idx ].merge( TBoundingBox::around( vertices[ idx + 1 ], m_radius ) );
+  }
+
+  // children are after parent
+  for( auto node = m_nodes.rbegin(); node != m_nodes.rend(); ++node )
+  {
+    if( node->left )
+    {
+      node->box = m_nodes[ node->left ].box;
+      node->box.merge( m_nodes[ node->right ].box );
+      continue;
+    }
+    node->box = m_segments[ node->begin ];
+    for( size_t idx = node->begin + 1; idx < node->end; ++idx )
+      node->box.merge( m_segments[ idx ] );
+  }
+}
+
+void CSegmentTree::query( const TBoundingBox &box, TFrameVector<size_t> &segments ) const
+{
+  query( [ &box ]( const TBoundingBox &other ){ return box.overlaps( other ); }, segments );
+}
+
+void CSegmentTree::query( const TVector<2> &position, const TVector<2> &direction,
+                          TFrameVector<size_t> &segments ) const
+{
+  query( [ &position, &direction ]( const TBoundingBox &box )
+         {
+           return box.hitBy( position, direction );
+         }, segments );
+}
+
+bool CSegmentTree::empty() const
+{
+  return m_nodes.empty();
+}
+
+template <typename test>
+void CSegmentTree::query( const test &accepts, TFrameVector<size_t> &segments ) const
+{
+  if( m_nodes.empty() )
+    return;
+  size_t stack[ 64 ];
+  size_t stackSize = 0;
+  stack[ stackSize++ ] = 0;
+  while( stackSize )
+  {
+    const TNode &node = m_nodes[ stack[ --stackSize ] ];
+    if( !accepts( node.box ) )
+      continue;
+    if( node.left )
+    {
+      // right first, so segments are reported in ascending order
+      stack[ stackSize++ ] = node.right;
+      stack[ stackSize++ ] = node.left;
+      continue;
+    }
+    for( size_t idx = node.begin; idx < node.end; ++idx )
+      if( accepts( m_segments[ idx ] ) )
+        segments.push_back( idx );
+  }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "linearAlgebra.hpp"
+#include "frameArena.hpp"
+#include <vector>
+
+
+/**
+ * Axis aligned bounding box.
+ */
+struct TBoundingBox
+{
+  /**
+   * Bottom-left and top-right corner.
+   */
+  TVector<2> min, max;
+
+  /**
+   * @param centre
+   * @param radius
+   * @return Box around circle.
+   */
+  static TBoundingBox around( const TVector<2> &centre, TScalar radius );
+
+  /**
+   * @param points
+   * @return Smallest box containing all points.
+   */
+  static TBoundingBox around( const TMatrix<2, 4> &points );
+
+  /**
+   * Grows box to contain other box.
+   * @param other
+   */
+  void merge( const TBoundingBox &other );
+
+  /**
+   * @param other
+   * @return True if boxes overlap or touch.
+   */
+  [[nodiscard]] bool overlaps( const TBoundingBox &other ) const;
+
+  /**
+   * @param position ray origin
+   * @param direction ray direction
+   * @return True if ray hits box, also if it starts inside.
+   */
+  [[nodiscard]] bool hitBy( const TVector<2> &position, const TVector<2> &direction ) const;
+};
+
+/**
+ * Bounding volume hierarchy over segments of line strip with rounded ends.
+ * Segment idx connects vertex idx and idx + 1. Nodes cover continuous ranges of segments,
+ * so neighbouring segments of strip share subtrees. Topology is fixed after build,
+ * moving vertices only needs refit.
+ */
+class CSegmentTree
+{
+public:
+  /**
+   * Builds tree over line strip.
+   * @param vertices vertices of line strip
+   * @param radius half-width of segments
+   */
+  void build( const std::vector<TVector<2>> &vertices, TScalar radius );
+
+  /**
+   * Recalculates boxes after vertices moved, vertex count must be same as in build.
+   * @param vertices vertices of line strip
+   */
+  void refit( const std::vector<TVector<2>> &vertices );
+
+  /**
+   * Finds segments whose box overlaps box.
+   * @param box query box
+   * @param segments storage for segment indices, ascending
+   */
+  void query( const TBoundingBox &box, TFrameVector<size_t> &segments ) const;
+
+  /**
+   * Finds segments whose box is hit by ray.
+   * @param position ray origin
+   * @param direction ray direction
+   * @param segments storage for segment indices, ascending
+   */
+  void query( const TVector<2> &position, const TVector<2> &direction,
+              TFrameVector<size_t> &segments ) const;
+
+  /**
+   * @return True if tree has no segments.
+   */
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * Maximal number of segments in leaf.
+   */
+  static const size_t leafSize;
+
+private:
+  /**
+   * Node covering segments [begin, end). Leaf has no children.
+   */
+  struct TNode
+  {
+    TBoundingBox box;
+    size_t begin, end;
+    size_t left = 0, right = 0;
+  };
+
+  /**
+   * Builds subtree over segments [begin, end).
+   * @return Index of subtree root.
+   */
+  size_t build( size_t begin, size_t end );
+
+  /**
+   * Reports segments of subtree accepted by test.
+   */
+  template <typename test>
+  void query( const test &accepts, TFrameVector<size_t> &segments ) const;
+
+  /**
+   * Nodes, parent is always before its children, root is first.
+   */
+  std::vector<TNode> m_nodes;
+
+  /**
+   * Box of each segment.
+   */
+  std::vector<TBoundingBox> m_segments;
+
+  /**
+   * Half-width of segments, including small margin for rounding errors of exact tests.
+   */
+  TScalar m_radius = 0;
+};
@@ -0,0 +1,173 @@
+#include "sessionLog.hpp"
+#include <cstring>
+
+
+using namespace std;
+
+static const char sessionMagic[] = "PA2S";
+static const uint8_t sessionVersion = 2;
+
+/**
+ * Maps signed integer to unsigned so small negative numbers stay short.
+ */
+static uint64_t zigZag( int value )
+{
+  return ( (uint64_t)value << 1 ) ^ (uint64_t)( value < 0 ? -1 : 0 );
+}
+
+static int unZigZag( uint64_t value )
+{
+  return (int)( value >> 1 ) ^ -(int)( value & 1 );
+}
+
+static void mixHash( uint64_t &hash, double value )
+{
+  unsigned char bytes[ sizeof( double ) ];
+  memcpy( bytes, &value, sizeof( double ) );
+  for( unsigned char byte: bytes )
+  {
+    hash ^= byte;
+    hash *= 0x100000001b3;
+  }
+}
+
+
+CSessionLog::CSessionLog( const string &fileName )
+{
+  ifstream file( fileName, ios::binary );
+  if( !file )
+    throw invalid_argument( "Can not open session log " + fileName + ".\n" );
+  file.exceptions( ios::failbit | ios::badbit );
+
+  try
+  {
+    char magic[ 4 ];
+    file.read( magic, 4 );
+    if( memcmp( magic, sessionMagic, 4 ) != 0 || file.get() != sessionVersion )
+      throw invalid_argument( fileName + " is not session log.\n" );
+
+    levelFileName.resize( readNumber( file ) );
+    file.read( levelFileName.data(), (streamsize)levelFileName.size() );
+    levelHash = readHash( file );
+
+    size_t step = 0;
+    while( file.peek() != char_traits<char>::eof() )
+    {
+      TSessionEvent event{};
+      step += readNumber( file );
+      event.step = step;
+      event.type = (ESessionEvent)file.get();
+      switch( event.type )
+      {
+        case ESessionEvent::mouseDown:
+        case ESessionEvent::mouseUp:
+        case ESessionEvent::mouseMove:
+          event.x = unZigZag( readNumber( file ) );
+          event.y = unZigZag( readNumber( file ) );
+          break;
+        case ESessionEvent::key:
+          event.key = (unsigned char)file.get();
+          break;
+        case ESessionEvent::end:
+          event.stateHash = readHash( file );
+          break;
+        default:
+          throw invalid_argument( "Unknown event in session log " + fileName + ".\n" );
+      }
+      events.push_back( event );
+    }
+  }
+  catch( const ios::failure & )
+  {
+    throw invalid_argument( "Session log " + fileName + " is truncated.\n" );
+  }
+}
+
+uint64_t CSessionLog::stateHash( const vector<CPhysicsObject *> &objects )
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  for( const auto object: objects )
+  {
+    const auto &attributes = object->m_attributes;
+    for( double value: { object->m_position[ 0 ], object->m_position[ 1 ], object->m_rotation,
+                         attributes.velocity[ 0 ], attributes.velocity[ 1 ],
+                         attributes.angularVelocity, attributes.integrity } )
+      mixHash( hash, value );
+  }
+  return hash;
+}
+
+uint64_t CSessionLog::readNumber( istream &stream )
+{
+  uint64_t number = 0;
+  for( size_t shift = 0; shift < 64; shift += 7 )
+  {
+    auto byte = (uint64_t)(unsigned char)stream.get();
+    number |= ( byte & 0x7f ) << shift;
+    if( !( byte & 0x80 ) )
+      return number;
+  }
+  throw invalid_argument( "Invalid number in session log.\n" );
+}
+
+uint64_t CSessionLog::readHash( istream &stream )
+{
+  uint64_t hash = 0;
+  for( size_t idx = 0; idx < 8; ++idx )
+    hash |= (uint64_t)(unsigned char)stream.get() << ( 8 * idx );
+  return hash;
+}
+
+
+CSessionRecorder::CSessionRecorder( const string &fileName, const string &levelFileName, uint64_t levelHash )
+  : m_file( fileName, ios::binary )
+{
+  if( !m_file )
+    throw invalid_argument( "Can not create session log " + fileName + ".\n" );
+  m_file.write( sessionMagic, 4 );
+  m_file.put( (char)sessionVersion );
+  writeNumber( levelFileName.size() );
+  m_file.write( levelFileName.data(), (streamsize)levelFileName.size() );
+  writeHash( levelHash );
+  m_file.flush();
+}
+
+void CSessionRecorder::record( const TSessionEvent &event )
+{
+  writeNumber( event.step - m_lastStep );
+  m_lastStep = event.step;
+  m_file.put( (char)event.type );
+  switch( event.type )
+  {
+    case ESessionEvent::mouseDown:
+    case ESessionEvent::mouseUp:
+    case ESessionEvent::mouseMove:
+      writeNumber( zigZag( event.x ) );
+      writeNumber( zigZag( event.y ) );
+      break;
+    case ESessionEvent::key:
+      m_file.put( (char)event.key );
+      break;
+    case ESessionEvent::end:
+      writeHash( event.stateHash );
+      break;
+  }
+  // session is kept even if game does not end properly
+  m_file.flush();
+}
+
+void CSessionRecorder::writeNumber( uint64_t number )
+{
+  while( number >= 0x80 )
+  {
+    m_file.put( (char)( ( number & 0x7f ) | 0x80 ) );
+    number >>= 7;
+  }
+  m_file.put( (char)number );
+}
+
+void CSessionRecorder::writeHash( uint64_t hash )
+{
+  for( size_t idx = 0; idx < 8; ++idx )
+    m_file.put( (char)( hash >> ( 8 * idx ) ) );
+}
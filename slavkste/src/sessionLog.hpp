@@ -0,0 +1,147 @@
+#pragma once
+
+#include "physicsObject.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+
+/**
+ * Type of recorded game input.
+ */
+enum class ESessionEvent : uint8_t
+{
+  mouseDown,
+  mouseUp,
+  mouseMove,
+  key,
+  end
+};
+
+/**
+ * Game input recorded in session.
+ */
+struct TSessionEvent
+{
+  /**
+   * Number of physics steps done by game before event.
+   */
+  size_t step;
+
+  /**
+   * Event type.
+   */
+  ESessionEvent type;
+
+  /**
+   * Scene coordinates of mouse events.
+   */
+  int x = 0, y = 0;
+
+  /**
+   * Pressed key of key event.
+   */
+  unsigned char key = 0;
+
+  /**
+   * State hash of objects at end event.
+   */
+  uint64_t stateHash = 0;
+};
+
+/**
+ * Recorded game session. Level file and inputs with physics step in which they came.
+ *
+ * Binary format: magic "PA2S", version byte, level file name, level hash,
+ * then events as step difference, type byte and type specific payload.
+ * Numbers are stored as variable length integers, except level and state hash.
+ */
+class CSessionLog
+{
+public:
+  /**
+   * Loads session log.
+   * @param fileName
+   * @throws std::invalid_argument if file can not be read or is not session log.
+   */
+  explicit CSessionLog( const std::string &fileName );
+
+  /**
+   * Hash of positions, rotations, velocities and integrity of objects.
+   * Equal hashes mean bit-identical simulation state.
+   * @param objects
+   * @return State hash.
+   */
+  static uint64_t stateHash( const std::vector<CPhysicsObject *> &objects );
+
+  /**
+   * First level of session.
+   */
+  std::string levelFileName;
+
+  /**
+   * Hash of contents of first level and levels following it at time of recording.
+   * ( CLevelLoader::levelHash )
+   */
+  uint64_t levelHash = 0;
+
+  /**
+   * Recorded events ordered by step.
+   */
+  std::vector<TSessionEvent> events;
+
+private:
+  /**
+   * Reads variable length integer.
+   */
+  static uint64_t readNumber( std::istream &stream );
+
+  /**
+   * Reads 8 byte little endian hash.
+   */
+  static uint64_t readHash( std::istream &stream );
+};
+
+/**
+ * Writes game session to session log.
+ */
+class CSessionRecorder
+{
+public:
+  /**
+   * Creates log file and writes header.
+   * @param fileName log file
+   * @param levelFileName first level of session
+   * @param levelHash hash of contents of levels
+   * @throws std::invalid_argument if file can not be created.
+   */
+  CSessionRecorder( const std::string &fileName, const std::string &levelFileName, uint64_t levelHash );
+
+  /**
+   * Appends event to log. Events must come in order of steps.
+   * @param event
+   */
+  void record( const TSessionEvent &event );
+
+private:
+  /**
+   * Writes variable length integer.
+   */
+  void writeNumber( uint64_t number );
+
+  /**
+   * Writes 8 byte little endian hash.
+   */
+  void writeHash( uint64_t hash );
+
+  /**
+   * Log file.
+   */
+  std::ofstream m_file;
+
+  /**
+   * Step of last recorded event.
+   */
+  size_t m_lastStep = 0;
+};
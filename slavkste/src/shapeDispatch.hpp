@@ -0,0 +1,95 @@
+#pragma once
+
+#include "circle.hpp"
+#include "rectangle.hpp"
+#include "complexObject.hpp"
+#include <array>
+#include <utility>
+
+
+namespace collision
+{
+
+/**
+ * Calculates collision manifold of two objects.
+ */
+using TManifoldFunction = TManifold ( * )( CPhysicsObject *first, CPhysicsObject *second );
+
+/**
+ * Class of objects with shape type.
+ */
+template <EShapeType shapeType>
+struct TShapeClass;
+
+template <>
+struct TShapeClass<EShapeType::CIRCLE>
+{
+  using type = CCircle;
+};
+
+template <>
+struct TShapeClass<EShapeType::RECTANGLE>
+{
+  using type = CRectangle;
+};
+
+template <>
+struct TShapeClass<EShapeType::COMPLEX>
+{
+  using type = CComplexObject;
+};
+
+/**
+ * @param first, second shape type
+ * @return Index of shape pair type in manifoldFunctions.
+ */
+constexpr size_t shapePair( EShapeType first, EShapeType second )
+{
+  return (size_t)first * shapeTypeCount + (size_t)second;
+}
+
+/**
+ * Calculates manifold of objects with known shapes, same as first->getManifold( second ).
+ * Implementation of object with larger shape type is called directly, without virtual calls.
+ * @tparam firstType, secondType shape type of objects
+ * @param first, second colliding objects
+ * @return Collision manifold.
+ */
+template <EShapeType firstType, EShapeType secondType>
+TManifold shapeManifold( CPhysicsObject *first, CPhysicsObject *second )
+{
+  using TFirst = typename TShapeClass<firstType>::type;
+  using TSecond = typename TShapeClass<secondType>::type;
+  if constexpr( secondType >= firstType )
+    return static_cast<TSecond *>( second )->TSecond::getManifold( static_cast<TFirst *>( first ) );
+  else
+    return static_cast<TFirst *>( first )->TFirst::getManifold( static_cast<TSecond *>( second ) );
+}
+
+/**
+ * Builds table of shapeManifold for all shape pair types.
+ */
+template <size_t... pairs>
+constexpr std::array<TManifoldFunction, sizeof...( pairs )> manifoldTable( std::index_sequence<pairs...> )
+{
+  return { &shapeManifold<EShapeType( pairs / shapeTypeCount ), EShapeType( pairs % shapeTypeCount )>... };
+}
+
+/**
+ * Collision function of each shape pair type, indexed by shapePair.
+ */
+inline constexpr std::array<TManifoldFunction, shapeTypeCount * shapeTypeCount> manifoldFunctions =
+        manifoldTable( std::make_index_sequence<shapeTypeCount * shapeTypeCount>() );
+
+/**
+ * Calculates collision manifold of two objects by their shape types.
+ * Result is same as of first->getManifold( second ).
+ * @param first, second colliding objects
+ * @return Collision manifold.
+ */
+inline TManifold getManifold( CPhysicsObject *first, CPhysicsObject *second )
+{
+  return manifoldFunctions[ shapePair( first->m_shapeType, second->m_shapeType ) ]( first, second );
+}
+
+} // namespace collision
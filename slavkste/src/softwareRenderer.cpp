@@ -0,0 +1,176 @@
+#include "softwareRenderer.hpp"
+#include <algorithm>
+#include <fstream>
+
+
+using namespace std;
+
+const size_t CSoftwareRenderer::glyphWidth = 11;
+const size_t CSoftwareRenderer::glyphHeight = 17;
+
+/**
+ * Depth of cleared pixel, same as far plane of openGL window.
+ */
+static const double clearDepth = -1;
+
+/**
+ * @param component colour component in range 0 - 1
+ * @return Component in range 0 - 255.
+ */
+static uint8_t toByte( double component )
+{
+  return (uint8_t)lround( clamp( component, 0., 1. ) * 255 );
+}
+
+CSoftwareRenderer::CSoftwareRenderer( size_t width, size_t height )
+  : m_width( width ),
+    m_height( height ),
+    m_clipRight( (long)width ),
+    m_clipTop( (long)height ),
+    m_pixels( 3 * width * height, 0 ),
+    m_depth( width * height, clearDepth )
+{}
+
+void CSoftwareRenderer::setView( const TVector<2> &viewOrigin, const TVector<2> &viewExtreme,
+                                 const TVector<2> &viewportOrigin, double scale )
+{
+  m_viewOrigin = viewOrigin;
+  m_viewportOrigin = viewportOrigin;
+  m_scale = scale;
+
+  TVector<2> viewSize = viewExtreme - viewOrigin;
+  m_clipLeft = max( 0l, (long)viewportOrigin[ 0 ] );
+  m_clipBottom = max( 0l, (long)viewportOrigin[ 1 ] );
+  m_clipRight = min( (long)m_width, (long)viewportOrigin[ 0 ] + (long)( scale * viewSize[ 0 ] ) );
+  m_clipTop = min( (long)m_height, (long)viewportOrigin[ 1 ] + (long)( scale * viewSize[ 1 ] ) );
+}
+
+void CSoftwareRenderer::clear()
+{
+  fill( m_pixels.begin(), m_pixels.end(), 0 );
+  fill( m_depth.begin(), m_depth.end(), clearDepth );
+}
+
+void CSoftwareRenderer::drawTriangles( const vector<float> &vertices, const TPen &pen )
+{
+  uint8_t color[ 3 ] = { toByte( pen.r ), toByte( pen.g ), toByte( pen.b ) };
+  for( size_t idx = 0; idx + 6 <= vertices.size(); idx += 6 )
+    fillTriangle( toPixels( { vertices[ idx ], vertices[ idx + 1 ] } ),
+                  toPixels( { vertices[ idx + 2 ], vertices[ idx + 3 ] } ),
+                  toPixels( { vertices[ idx + 4 ], vertices[ idx + 5 ] } ),
+                  color, pen.depth );
+}
+
+void CSoftwareRenderer::drawText( const TVector<2> &position, const string &text, const TPen &pen )
+{
+  if( text.empty() )
+    return;
+  uint8_t color[ 3 ] = { toByte( pen.r ), toByte( pen.g ), toByte( pen.b ) };
+  TVector<2> baseline = toPixels( position );
+  long textWidth = (long)( text.size() * ( glyphWidth + 1 ) - 1 );
+  long x = lround( baseline[ 0 ] ) - textWidth / 2,
+       y = lround( baseline[ 1 ] );
+
+  for( const auto &c: text )
+  {
+    if( c != ' ' )
+      fillRectangle( x + 1, y, x + (long)glyphWidth - 1, y + (long)glyphHeight, color, pen.depth );
+    x += (long)glyphWidth + 1;
+  }
+}
+
+void CSoftwareRenderer::present()
+{}
+
+size_t CSoftwareRenderer::width() const
+{
+  return m_width;
+}
+
+size_t CSoftwareRenderer::height() const
+{
+  return m_height;
+}
+
+const vector<uint8_t> &CSoftwareRenderer::pixels() const
+{
+  return m_pixels;
+}
+
+void CSoftwareRenderer::writePPM( ostream &stream ) const
+{
+  stream << "P6\n" << m_width << ' ' << m_height << "\n255\n";
+  stream.write( reinterpret_cast<const char *>( m_pixels.data() ), (streamsize)m_pixels.size() );
+}
+
+void CSoftwareRenderer::writePPM( const string &fileName ) const
+{
+  ofstream file( fileName, ios::binary );
+  if( !file )
+    throw invalid_argument( "Can not create image " + fileName + ".\n" );
+  writePPM( file );
+}
+
+void CSoftwareRenderer::fillTriangle( const TVector<2> &a, const TVector<2> &b, const TVector<2> &c,
+                                      const uint8_t *color, double depth )
+{
+  double ax = a[ 0 ], ay = a[ 1 ],
+         bx = b[ 0 ], by = b[ 1 ],
+         cx = c[ 0 ], cy = c[ 1 ];
+
+  double area = ( bx - ax ) * ( cy - ay ) - ( by - ay ) * ( cx - ax );
+  if( area == 0 || isnan( area ) )
+    return;
+  // corners are made counter-clockwise, so inside is left of all edges
+  if( area < 0 )
+  {
+    swap( bx, cx );
+    swap( by, cy );
+  }
+
+  // pixel covers area [ column, column + 1 ) x [ row, row + 1 ) and is sampled in its center
+  long left = max( m_clipLeft, (long)ceil( min( { ax, bx, cx } ) - 0.5 ) );
+  long right = min( m_clipRight - 1, (long)floor( max( { ax, bx, cx } ) - 0.5 ) );
+  long bottom = max( m_clipBottom, (long)ceil( min( { ay, by, cy } ) - 0.5 ) );
+  long top = min( m_clipTop - 1, (long)floor( max( { ay, by, cy } ) - 0.5 ) );
+
+  auto edge = []( double px, double py, double qx, double qy, double x, double y )
+  {
+    return ( qx - px ) * ( y - py ) - ( qy - py ) * ( x - px );
+  };
+
+  for( long row = bottom; row <= top; ++row )
+  {
+    double y = (double)row + 0.5;
+    for( long column = left; column <= right; ++column )
+    {
+      double x = (double)column + 0.5;
+      if( edge( ax, ay, bx, by, x, y ) >= 0 &&
+          edge( bx, by, cx, cy, x, y ) >= 0 &&
+          edge( cx, cy, ax, ay, x, y ) >= 0 )
+        plot( (size_t)column, (size_t)row, color, depth );
+    }
+  }
+}
+
+void CSoftwareRenderer::fillRectangle( long left, long bottom, long right, long top,
+                                       const uint8_t *color, double depth )
+{
+  for( long row = max( bottom, m_clipBottom ); row < min( top, m_clipTop ); ++row )
+    for( long column = max( left, m_clipLeft ); column < min( right, m_clipRight ); ++column )
+      plot( (size_t)column, (size_t)row, color, depth );
+}
+
+void CSoftwareRenderer::plot( size_t column, size_t row, const uint8_t *color, double depth )
+{
+  size_t idx = ( m_height - 1 - row ) * m_width + column;
+  if( !( depth > m_depth[ idx ] ) )
+    return;
+  m_depth[ idx ] = depth;
+  copy( color, color + 3, m_pixels.begin() + (long)( 3 * idx ) );
+}
+
+TVector<2> CSoftwareRenderer::toPixels( const TVector<2> &point ) const
+{
+  return m_viewportOrigin + ( point - m_viewOrigin ) * m_scale;
+}
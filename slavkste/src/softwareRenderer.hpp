@@ -0,0 +1,135 @@
+#pragma once
+
+#include "renderer.hpp"
+#include <cstdint>
+#include <ostream>
+
+/**
+ * Renderer rasterizing frames to memory, needs no display nor GPU.
+ * Pixels covered by triangle are those with center inside of it, depth is tested
+ * like in openGL window, so frames match openGL frames up to edge pixels.
+ * Alpha is ignored, same as in openGL window without blending.
+ * Text is drawn as solid block in place of each character, spaces are left empty.
+ */
+class CSoftwareRenderer : public CRenderer
+{
+public:
+  /**
+   * Creates black frame.
+   * @param width frame width in pixels
+   * @param height frame height in pixels
+   */
+  CSoftwareRenderer( size_t width, size_t height );
+
+  void setView( const TVector<2> &viewOrigin, const TVector<2> &viewExtreme,
+                const TVector<2> &viewportOrigin, double scale ) override;
+
+  void clear() override;
+
+  void drawTriangles( const std::vector<float> &vertices, const TPen &pen ) override;
+
+  void drawText( const TVector<2> &position, const std::string &text, const TPen &pen ) override;
+
+  /**
+   * Frame is kept in memory until next clear.
+   */
+  void present() override;
+
+  /**
+   * @return Frame width in pixels.
+   */
+  [[nodiscard]] size_t width() const;
+
+  /**
+   * @return Frame height in pixels.
+   */
+  [[nodiscard]] size_t height() const;
+
+  /**
+   * @return RGB triplets of frame pixels, rows from top to bottom.
+   */
+  [[nodiscard]] const std::vector<uint8_t> &pixels() const;
+
+  /**
+   * Writes frame as binary PPM image.
+   * @param stream
+   */
+  void writePPM( std::ostream &stream ) const;
+
+  /**
+   * Writes frame to binary PPM file.
+   * @param fileName
+   */
+  void writePPM( const std::string &fileName ) const;
+
+  /**
+   * Size of character cell of text in pixels.
+   */
+  static const size_t glyphWidth, glyphHeight;
+
+private:
+  /**
+   * Fills pixels with center inside of triangle.
+   * @param a, b, c corners in pixels
+   * @param color RGB of pen
+   * @param depth
+   */
+  void fillTriangle( const TVector<2> &a, const TVector<2> &b, const TVector<2> &c,
+                     const uint8_t *color, double depth );
+
+  /**
+   * Fills rectangle of pixels.
+   * @param left, bottom first pixel column and row from bottom-left corner of frame
+   * @param right, top column and row past filled area
+   * @param color RGB of pen
+   * @param depth
+   */
+  void fillRectangle( long left, long bottom, long right, long top,
+                      const uint8_t *color, double depth );
+
+  /**
+   * Sets pixel if depth is larger than depth of pixel.
+   * @param column, row pixel from bottom-left corner of frame
+   * @param color RGB of pen
+   * @param depth
+   */
+  void plot( size_t column, size_t row, const uint8_t *color, double depth );
+
+  /**
+   * @param point scene coordinates
+   * @return Point in pixels from bottom-left corner of frame.
+   */
+  [[nodiscard]] TVector<2> toPixels( const TVector<2> &point ) const;
+
+  size_t m_width, m_height;
+
+  /**
+   * Bottom-left of scene area.
+   */
+  TVector<2> m_viewOrigin;
+
+  /**
+   * Bottom-left of viewport in pixels.
+   */
+  TVector<2> m_viewportOrigin;
+
+  /**
+   * Pixels per scene unit.
+   */
+  double m_scale = 1;
+
+  /**
+   * Pixel area drawing is clipped to, from bottom-left corner of frame.
+   */
+  long m_clipLeft = 0, m_clipBottom = 0, m_clipRight = 0, m_clipTop = 0;
+
+  /**
+   * RGB triplets of pixels, rows from top to bottom.
+   */
+  std::vector<uint8_t> m_pixels;
+
+  /**
+   * Depth of pixels, rows from top to bottom.
+   */
+  std::vector<double> m_depth;
+};
@@ -9,7 +9,5 @@ CText::CText( TVector<2> position, std::string text )
 
 void CText::render( CWindow &win ) const
 {
-  glTranslated( 0, 0, 1 );
   win.drawText( m_position, text );
-  glTranslated( 0, 0, -1 );
 }
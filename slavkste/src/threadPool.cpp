@@ -0,0 +1,91 @@
+#include "threadPool.hpp"
+
+
+using namespace std;
+
+thread_local size_t CThreadPool::s_threadIndex = 0;
+thread_local const CThreadPool *CThreadPool::s_threadPool = nullptr;
+
+CThreadPool::CThreadPool( size_t threadCount )
+{
+  for( size_t idx = 1; idx < threadCount; ++idx )
+    m_workers.emplace_back( &CThreadPool::workerLoop, this, idx );
+}
+
+CThreadPool::~CThreadPool()
+{
+  {
+    lock_guard<mutex> lock( m_mutex );
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for( auto &worker: m_workers )
+    worker.join();
+}
+
+void CThreadPool::run( size_t count, const void *task, void ( *invoke )( const void *, size_t ) )
+{
+  {
+    lock_guard<mutex> lock( m_mutex );
+    m_task = task;
+    m_invoke = invoke;
+    m_count = count;
+    // few chunks per thread, so faster threads can take over work of slower ones
+    m_chunk = max( count / ( threadCount() * 4 ), (size_t)1 );
+    m_next = 0;
+    m_busy = m_workers.size();
+    ++m_generation;
+  }
+  m_wake.notify_all();
+
+  runChunks();
+
+  unique_lock<mutex> lock( m_mutex );
+  m_done.wait( lock, [ this ](){ return m_busy == 0; } );
+  m_task = nullptr;
+}
+
+size_t CThreadPool::threadCount() const
+{
+  return m_workers.size() + 1;
+}
+
+size_t CThreadPool::threadIndex() const
+{
+  return s_threadPool == this ? s_threadIndex : 0;
+}
+
+void CThreadPool::workerLoop( size_t index )
+{
+  s_threadIndex = index;
+  s_threadPool = this;
+  size_t seenGeneration = 0;
+  while( true )
+  {
+    unique_lock<mutex> lock( m_mutex );
+    m_wake.wait( lock, [ this, seenGeneration ](){ return m_stop || m_generation != seenGeneration; } );
+    if( m_stop )
+      return;
+    seenGeneration = m_generation;
+    lock.unlock();
+
+    runChunks();
+
+    lock.lock();
+    if( --m_busy == 0 )
+      m_done.notify_one();
+  }
+}
+
+void CThreadPool::runChunks()
+{
+  while( true )
+  {
+    size_t begin = m_next.fetch_add( m_chunk );
+    if( begin >= m_count )
+      return;
+    size_t end = min( begin + m_chunk, m_count );
+    for( size_t idx = begin; idx < end; ++idx )
+      m_invoke( m_task, idx );
+  }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+/**
+ * Fixed pool of worker threads for data parallel loops.
+ * Calling thread takes part in work, so pool of n threads starts n - 1 workers.
+ */
+class CThreadPool
+{
+public:
+  /**
+   * Starts threadCount - 1 workers.
+   * @param threadCount number of threads working on each loop
+   */
+  explicit CThreadPool( size_t threadCount );
+  CThreadPool( const CThreadPool & ) = delete;
+  CThreadPool &operator=( const CThreadPool & ) = delete;
+
+  /**
+   * Stops and joins workers.
+   */
+  ~CThreadPool();
+
+  /**
+   * Calls task for all indices in [ 0, count ), indices are processed in chunks
+   * by all threads. Returns after all calls finished.
+   * Task must be safe to call concurrently for different indices.
+   * Task is called by reference, so loop does not allocate.
+   * @tparam task_t callable with index
+   * @param count
+   * @param task
+   */
+  template <typename task_t>
+  void parallelFor( size_t count, const task_t &task );
+
+  /**
+   * @return Number of threads working on each loop.
+   */
+  [[nodiscard]] size_t threadCount() const;
+
+  /**
+   * @return Index of worker of this pool calling this function, in [ 1, threadCount ).
+   * 0 for threads which are not workers of this pool, so thread calling parallelFor
+   * has index 0 even if it is worker of another pool.
+   */
+  [[nodiscard]] size_t threadIndex() const;
+
+private:
+  /**
+   * Calls task for indices in [ 0, count ) on all threads.
+   * @param count
+   * @param task
+   * @param invoke calls task with index
+   */
+  void run( size_t count, const void *task, void ( *invoke )( const void *, size_t ) );
+
+  /**
+   * Waits for loops and works on them until pool is destroyed.
+   * @param index index of worker
+   */
+  void workerLoop( size_t index );
+
+  /**
+   * Takes chunks of current loop until none is left.
+   */
+  void runChunks();
+
+  /**
+   * Worker threads.
+   */
+  std::vector<std::thread> m_workers;
+
+  /**
+   * Guards loop state.
+   */
+  std::mutex m_mutex;
+
+  /**
+   * Signals new loop or stop to workers.
+   */
+  std::condition_variable m_wake;
+
+  /**
+   * Signals end of work of last worker.
+   */
+  std::condition_variable m_done;
+
+  /**
+   * Task of current loop.
+   */
+  const void *m_task = nullptr;
+
+  /**
+   * Calls task of current loop with index.
+   */
+  void ( *m_invoke )( const void *, size_t ) = nullptr;
+
+  /**
+   * Index count of current loop.
+   */
+  size_t m_count = 0;
+
+  /**
+   * Indices taken at once by thread.
+   */
+  size_t m_chunk = 1;
+
+  /**
+   * First index not taken by any thread.
+   */
+  std::atomic<size_t> m_next{ 0 };
+
+  /**
+   * Workers still working on current loop.
+   */
+  size_t m_busy = 0;
+
+  /**
+   * Counter of started loops, workers use it to recognise new loop.
+   */
+  size_t m_generation = 0;
+
+  /**
+   * Workers should end.
+   */
+  bool m_stop = false;
+
+  /**
+   * Index of worker running on thread in its pool.
+   */
+  static thread_local size_t s_threadIndex;
+
+  /**
+   * Pool of worker running on thread, nullptr for threads which are not workers.
+   */
+  static thread_local const CThreadPool *s_threadPool;
+};
+
+template <typename task_t>
+void CThreadPool::parallelFor( size_t count, const task_t &task )
+{
+  if( m_workers.empty() || count < 2 )
+  {
+    for( size_t idx = 0; idx < count; ++idx )
+      task( idx );
+    return;
+  }
+  run( count, &task, []( const void *loopTask, size_t idx )
+  {
+    ( *static_cast<const task_t *>( loopTask ) )( idx );
+  } );
+}
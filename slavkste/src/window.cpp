@@ -1,4 +1,5 @@
 #include "window.hpp"
+#include "glRenderer.hpp"
 
 
 using namespace std;
@@ -19,12 +20,23 @@ CWindow::CWindow( int *argcPtr, char *argv[] )
 
   // OpenGL init
   glEnable( GL_DEPTH_TEST );
+  m_renderer = make_unique<CGLRenderer>();
 
   // function callback registration
   glutReshapeFunc( &CWindow::resizeEventHandler );
 
 }
 
+CWindow::CWindow()
+  : m_headless( true )
+{}
+
+CWindow::CWindow( unique_ptr<CRenderer> renderer, int width, int height )
+  : m_headless( true ),
+    m_renderer( move( renderer ) ),
+    m_windowSize{ width, height }
+{}
+
 void CWindow::mainLoop() const
 {
   // enter GLUT event processing cycle
@@ -74,38 +86,37 @@ void CWindow::resizeWindowAction( int w, int h )
 
   m_scale = std::min( widthScale, heightScale );
 
-  // Use the Projection Matrix
-  glMatrixMode( GL_PROJECTION );
-
-  // Reset Matrix
-  glLoadIdentity();
-
-  // Set the viewport to be the entire window
-  glViewport( (GLint)( w - m_scale * viewWidth ) / 2,
-              (GLint)( h - m_scale * viewHeight ) / 2,
-              (GLint)( m_scale * viewWidth ),
-              (GLint)( m_scale * viewHeight ) );
-
-  // Set the correct perspective.
-  //gluPerspective( 60, ratio, 1, 100 );
-  gluOrtho2D( m_viewOrigin[ 0 ], m_viewExtreme[ 0 ], m_viewOrigin[ 1 ], m_viewExtreme[ 1 ] );
-
-  // Get Back to the Model view
-  glMatrixMode( GL_MODELVIEW );
+  // viewport is centered in window
+  TVector<2> viewportOrigin{ (int)( w - m_scale * viewWidth ) / 2,
+                             (int)( h - m_scale * viewHeight ) / 2 };
+  m_renderer->setView( m_viewOrigin, m_viewExtreme, viewportOrigin, m_scale );
 }
 
 void CWindow::resizeView( double left, double right, double bottom, double top )
 {
   m_viewOrigin = { left, bottom };
   m_viewExtreme = { right, top };
-  gluOrtho2D( left, right, bottom, top );
+  if( m_renderer && m_windowSize[ 0 ] > 0 && m_windowSize[ 1 ] > 0 )
+    resizeWindowAction( (int)m_windowSize[ 0 ], (int)m_windowSize[ 1 ] );
 }
 
 void CWindow::changeTitle( const std::string &title )
 {
+  if( m_headless )
+    return;
   glutSetWindowTitle( title.c_str() );
 }
 
+bool CWindow::headless() const
+{
+  return m_headless;
+}
+
+bool CWindow::drawing() const
+{
+  return m_renderer != nullptr;
+}
+
 TVector<2> CWindow::resolveCoordinates( int x, int y ) const
 {
   double viewWidth = m_viewExtreme[ 0 ] - m_viewOrigin[ 0 ];
@@ -138,136 +149,155 @@ void CWindow::drawLine( const TVector<2> &startPoint,
                         const TVector<2> &endPoint,
                         double width, ETag tags ) const
 {
-  applyPenColor( tags );
+  if( !m_renderer )
+    return;
   TVector<2> normal = crossProduct( endPoint - startPoint ).stretchedTo( width );
 
-  glBegin( GL_QUADS );
-  glVertex2d( ( startPoint + normal )[ 0 ], ( startPoint + normal )[ 1 ] );
-  glVertex2d( ( startPoint - normal )[ 0 ], ( startPoint - normal )[ 1 ] );
-  glVertex2d( ( endPoint - normal )[ 0 ], ( endPoint - normal )[ 1 ] );
-  glVertex2d( ( endPoint + normal )[ 0 ], ( endPoint + normal )[ 1 ] );
-  glEnd();
-  restorePenColor( tags );
+  auto &vertices = batch( tags );
+  addTriangle( vertices, startPoint + normal, startPoint - normal, endPoint - normal );
+  addTriangle( vertices, startPoint + normal, endPoint - normal, endPoint + normal );
 }
 
 void CWindow::drawCircle( const TVector<2> &centre, double radius, double angle, ETag tags ) const
 {
+  if( !m_renderer )
+    return;
   if( !isnan( angle ) )
   {
     TVector<2> dir = TVector<2>::canonical( 0, radius ).rotated( angle );
     TVector<2> normal = crossProduct( dir ).stretchedTo( radius / 20 );
 
-    glBegin( GL_QUADS );
-    glColor3d( 0, 0, 0 );
-    glTranslatef( 0, 0, -0.3 );
-
-    glVertex2d( ( centre + normal )[ 0 ], ( centre + normal )[ 1 ] );
-    glVertex2d( ( centre - normal )[ 0 ], ( centre - normal )[ 1 ] );
-
-    glVertex2d( ( centre + dir - normal )[ 0 ], ( centre + dir - normal )[ 1 ] );
-    glVertex2d( ( centre + dir + normal )[ 0 ], ( centre + dir + normal )[ 1 ] );
-
-    glTranslatef( 0, 0, 0.3 );
-    glEnd();
+    addTriangle( m_marks, centre + normal, centre - normal, centre + dir - normal );
+    addTriangle( m_marks, centre + normal, centre + dir - normal, centre + dir + normal );
   }
 
-  applyPenColor( tags );
-  static const size_t slices = 30;
-  TVector<2> lever = TVector<2>::canonical( 0, radius );
-  TMatrix<2, 2> rotationMatrix =
-          TMatrix<2, 2>::rotationMatrix2D( 2 * M_PI / slices );
-
-  glBegin( GL_TRIANGLE_FAN );
-  glVertex2d( centre[ 0 ], centre[ 1 ] );
-  glVertex2d( ( centre + lever )[ 0 ], ( centre + lever )[ 1 ] );
-  for( size_t i = 0; i < slices; i++ )
+  const auto &outline = unitCircle( circleDetail( radius ) );
+  auto &vertices = batch( tags );
+  TVector<2> middle = transformed( centre );
+  TVector<2> previous = transformed( centre + radius * outline[ 0 ] );
+  for( size_t idx = 1; idx < outline.size(); ++idx )
   {
-    lever = rotationMatrix * lever;
-    glVertex2d( ( centre + lever )[ 0 ], ( centre + lever )[ 1 ] );
+    TVector<2> next = transformed( centre + radius * outline[ idx ] );
+    addVertex( vertices, middle );
+    addVertex( vertices, previous );
+    addVertex( vertices, next );
+    previous = next;
   }
-
-  glEnd();
-  restorePenColor( tags );
 }
 
-CWindow *CWindow::instance = nullptr;
-
-void CWindow::drawText( const TVector<2> &position, const string &text ) const
+void CWindow::pushTransform( const TVector<2> &centre, double angle, const TVector<2> &offset ) const
 {
-  applyPenColor( NONE );
-  auto x = position[ 0 ],
-          y = position[ 1 ];
-
-  void *font = GLUT_BITMAP_TIMES_ROMAN_24;
-
-  double textWidth =
-          (double)( glutBitmapLength( font,
-                                      reinterpret_cast<const unsigned char *>(text.c_str()) )
-                    + text.size() - 1 ) / m_scale;
-  x -= textWidth / 2;
-
-  for( const auto &c: text )
+  if( !m_renderer )
+    return;
+  TMatrix<2, 2> rotation = TMatrix<2, 2>::rotationMatrix2D( angle );
+  TTransform transform{ rotation, centre + offset - rotation * centre };
+  if( !m_transforms.empty() )
   {
-    glRasterPos2d( x, y );
-    glutBitmapCharacter( font, c );
-    x += ( glutBitmapWidth( font, c ) + 1 ) / m_scale;
+    const auto &last = m_transforms.back();
+    transform = { { last.rotation * rotation[ 0 ], last.rotation * rotation[ 1 ] },
+                  last.rotation * transform.offset + last.offset };
   }
-  restorePenColor( NONE );
+  m_transforms.push_back( transform );
 }
 
-void CWindow::applyPenColor( ETag tags )
+void CWindow::popTransform() const
 {
-  double r = 1,
-          g = 1,
-          b = 1,
-          a = 1;
+  if( !m_renderer )
+    return;
+  m_transforms.pop_back();
+}
 
-  if( tags & ETag::TRANSPARENT )
+void CWindow::flush() const
+{
+  if( !m_renderer )
+    return;
+  TPen black;
+  black.r = black.g = black.b = 0;
+  m_renderer->drawTriangles( m_marks, black );
+  m_marks.clear();
+  for( auto &[ tags, vertices ]: m_batches )
   {
-    a = 0.3;
-    glTranslatef( 0, 0, 0.1 );
+    if( vertices.empty() )
+      continue;
+    m_renderer->drawTriangles( vertices, TPen::of( tags ) );
+    vertices.clear();
   }
+}
 
+void CWindow::clear() const
+{
+  if( !m_renderer )
+    return;
+  m_renderer->clear();
+}
 
-  if( tags & ETag::NON_SOLID )
-  {
-    r = 0.1;
-    g = 0.1;
-    b = 0.8;
-    a = 0.3;
-    glTranslatef( 0, 0, -0.2 );
-  }
+void CWindow::present() const
+{
+  if( !m_renderer )
+    return;
+  m_renderer->present();
+}
 
-  if( tags & ETag::TARGET )
-  {
-    r = 0.1;
-    g = 0.9;
-    b = 0.1;
-  }
+vector<float> &CWindow::batch( ETag tags ) const
+{
+  for( auto &batch: m_batches )
+    if( batch.tags == tags )
+      return batch.vertices;
+  m_batches.push_back( { tags, {} } );
+  return m_batches.back().vertices;
+}
 
-  if( tags & ETag::PLAYER )
-  {
-    r = 0.9;
-    g = 0.1;
-    b = 0.9;
-  }
+void CWindow::addTriangle( vector<float> &vertices,
+                           const TVector<2> &a, const TVector<2> &b, const TVector<2> &c ) const
+{
+  for( const auto *corner: { &a, &b, &c } )
+    addVertex( vertices, transformed( *corner ) );
+}
+
+void CWindow::addVertex( vector<float> &vertices, const TVector<2> &point )
+{
+  vertices.push_back( (float)point[ 0 ] );
+  vertices.push_back( (float)point[ 1 ] );
+}
+
+size_t CWindow::circleDetail( double radius ) const
+{
+  // outline with n slices deviates by radius * ( 1 - cos( pi / n ) ) ~ radius * pi^2 / 2n^2 pixels
+  double slices = M_PI * sqrt( radius * m_scale );
+  size_t detail = 0;
+  while( detail + 1 < circleDetailCount && (double)( 8 << detail ) < slices )
+    ++detail;
+  return detail;
+}
 
-  if( tags & ETag::HEALTH )
+const vector<TVector<2>> &CWindow::unitCircle( size_t detail ) const
+{
+  auto &outline = m_unitCircles[ detail ];
+  if( outline.empty() )
   {
-    r = 0.9;
-    g = 0.1;
-    b = 0.1;
+    size_t slices = 8 << detail;
+    for( size_t idx = 0; idx < slices; ++idx )
+      outline.push_back( TVector<2>::canonical( 0 ).rotated( 2 * M_PI * (double)idx / (double)slices ) );
+    outline.push_back( outline.front() );
   }
-
-  glColor4d( r, g, b, a );
+  return outline;
 }
 
-void CWindow::restorePenColor( ETag tags )
+TVector<2> CWindow::transformed( const TVector<2> &point ) const
 {
-  if( tags & ETag::TRANSPARENT )
-    glTranslatef( 0, 0, -0.1 );
+  if( m_transforms.empty() )
+    return point;
+  return m_transforms.back().rotation * point + m_transforms.back().offset;
+}
 
-  if( tags & ETag::NON_SOLID )
-    glTranslatef( 0, 0, 0.2 );
+CWindow *CWindow::instance = nullptr;
 
+void CWindow::drawText( const TVector<2> &position, const string &text ) const
+{
+  if( !m_renderer )
+    return;
+  // text is drawn over scene
+  TPen pen = TPen::of( NONE );
+  pen.depth = 1;
+  m_renderer->drawText( position, text, pen );
 }
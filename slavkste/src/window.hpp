@@ -2,9 +2,11 @@
 
 #include "linearAlgebra.hpp"
 #include "tags.hpp"
+#include "renderer.hpp"
 #include <GL/freeglut.h>
 #include <list>
 #include <vector>
+#include <array>
 #include <functional>
 #include <map>
 #include <utility>
@@ -29,6 +31,21 @@ public:
    */
   CWindow( int *argcPtr, char *argv[] );
 
+  /**
+   * Initialises headless window without glut and openGL context.
+   * View is still tracked, all drawing and event registration is ignored.
+   * Used for running simulation without display.
+   */
+  CWindow();
+
+  /**
+   * Initialises headless window drawing frames by renderer, e.g. CSoftwareRenderer.
+   * Event registration is ignored.
+   * @param renderer
+   * @param width, height window size in pixels
+   */
+  CWindow( std::unique_ptr<CRenderer> renderer, int width, int height );
+
   /**
    * Registers callback for glutDrawEvent request.
    * @tparam type
@@ -84,7 +101,7 @@ public:
   unsigned int registerMotionButtonEvent( type *cl, void(type::*callback)( int, int ) );
 
   /**
-   * Draws line.
+   * Draws line. Drawing is batched until flush.
    * @param startPoint
    * @param endPoint
    * @param width
@@ -96,6 +113,7 @@ public:
 
   /**
    * Draws circle with mark at angle. If angle is NAN no mark is drawn.
+   * Drawing is batched until flush.
    * @param centre
    * @param radius
    * @param angle
@@ -108,22 +126,42 @@ public:
 
   /**
    * Draws text. Center alignment.
+   * Text is drawn immediately, batched primitives drawn before should be flushed first.
    * @param position
    * @param text
    */
   void drawText( const TVector<2> &position, const std::string &text ) const;
 
   /**
-   * Apply colors and translation for tags.
-   * @param tags
+   * Draws all batched lines and circles, one draw call for each pen.
+   * Circle marks are drawn first, then batches in order of first use.
    */
-  static void applyPenColor( ETag tags );
+  void flush() const;
 
   /**
-   * Restores translation done by applyPenColor.
-   * @param tags
+   * Starts new frame.
+   */
+  void clear() const;
+
+  /**
+   * Shows finished frame, batched primitives should be flushed first.
+   */
+  void present() const;
+
+  /**
+   * Transforms following drawing until popTransform.
+   * Drawing is rotated by angle around centre and then moved by offset.
+   * Batched vertices are transformed before they are stored.
+   * @param centre
+   * @param angle
+   * @param offset
+   */
+  void pushTransform( const TVector<2> &centre, double angle, const TVector<2> &offset ) const;
+
+  /**
+   * Restores transformation before last pushTransform.
    */
-  static void restorePenColor( ETag tags );
+  void popTransform() const;
 
   /**
    * Moves camera to show area of scene.
@@ -151,7 +189,27 @@ public:
    */
   void mainLoop() const;
 
+  /**
+   * @return true if window has no glut context.
+   */
+  [[nodiscard]] bool headless() const;
+
+  /**
+   * @return true if window draws frames, false if all drawing is ignored.
+   */
+  [[nodiscard]] bool drawing() const;
+
 private:
+  /**
+   * Window has no glut context.
+   */
+  bool m_headless = false;
+
+  /**
+   * Backend drawing frames, null if drawing is ignored.
+   */
+  std::unique_ptr<CRenderer> m_renderer;
+
   /**
    * Bottom-left of view.
    */
@@ -172,6 +230,90 @@ private:
    */
   double m_scale = 1;
 
+  /**
+   * Triangles drawn with same tags, vertices are x, y pairs.
+   */
+  struct TBatch
+  {
+    ETag tags;
+    std::vector<float> vertices;
+  };
+
+  /**
+   * Transformation of batched vertices, point is mapped to rotation * point + offset.
+   */
+  struct TTransform
+  {
+    TMatrix<2, 2> rotation;
+    TVector<2> offset;
+  };
+
+  /**
+   * Batches of frame. Batches are kept between frames to reuse their storage.
+   */
+  mutable std::vector<TBatch> m_batches;
+
+  /**
+   * Triangles of circle marks, drawn black.
+   */
+  mutable std::vector<float> m_marks;
+
+  /**
+   * Transformations pushed by pushTransform, each composed with previous ones.
+   */
+  mutable std::vector<TTransform> m_transforms;
+
+  /**
+   * @param tags
+   * @return Vertices of batch drawn with tags.
+   */
+  std::vector<float> &batch( ETag tags ) const;
+
+  /**
+   * Adds transformed triangle to vertices.
+   * @param vertices
+   * @param a, b, c corners
+   */
+  void addTriangle( std::vector<float> &vertices,
+                    const TVector<2> &a, const TVector<2> &b, const TVector<2> &c ) const;
+
+  /**
+   * Adds already transformed point to vertices.
+   * @param vertices
+   * @param point
+   */
+  static void addVertex( std::vector<float> &vertices, const TVector<2> &point );
+
+  /**
+   * Number of circle levels of detail, circle of level detail has 8 << detail slices.
+   */
+  static const size_t circleDetailCount = 5;
+
+  /**
+   * Outlines of unit circle for each level of detail, computed on first use.
+   */
+  mutable std::array<std::vector<TVector<2>>, circleDetailCount> m_unitCircles;
+
+  /**
+   * Level of detail is chosen so that outline of circle on screen
+   * deviates from true circle by less than half of pixel.
+   * @param radius
+   * @return Level of detail of circle with radius.
+   */
+  [[nodiscard]] size_t circleDetail( double radius ) const;
+
+  /**
+   * @param detail
+   * @return Points of unit circle outline of level detail, last point is same as first.
+   */
+  const std::vector<TVector<2>> &unitCircle( size_t detail ) const;
+
+  /**
+   * @param point
+   * @return Point transformed by last pushed transformation.
+   */
+  [[nodiscard]] TVector<2> transformed( const TVector<2> &point ) const;
+
   /**
    * Handler of native glutDrawEvent.
    */
@@ -246,6 +388,8 @@ unsigned int
 CWindow::registerDrawEvent( type *cl, void(type::*callback)() )
 {
   redrawEventCallback = [ cl, callback ](){ ( cl->*callback )(); };
+  if( m_headless )
+    return 0;
   glutDisplayFunc( &CWindow::redrawEventHandler );
   return 0;
 }
@@ -257,6 +401,8 @@ CWindow::registerTimerEvent( type *cl,
                              types... values,
                              unsigned int time_ms )
 {
+  if( m_headless )
+    return 0;
   static int timerHandlerId = 0;
   timerEventCallbacks.emplace( timerHandlerId, [ cl, callback, values... ](){ ( cl->*callback )( values... ); } );
   glutTimerFunc( time_ms, &CWindow::timerEventHandler, timerHandlerId++ );
@@ -272,6 +418,8 @@ CWindow::registerKeyEvent( type *cl, void(type::*callback)( unsigned char, int,
     TVector<2> relativeCoord = resolveCoordinates( x, y );
     ( cl->*callback )( key, relativeCoord[ 0 ], relativeCoord[ 1 ] );
   };
+  if( m_headless )
+    return 0;
   glutKeyboardFunc( &CWindow::keyPressEventHandler );
   return 0;
 }
@@ -285,6 +433,8 @@ CWindow::registerMouseButtonEvent( type *cl, void(type::*callback)( int, int, in
     TVector<2> relativeCoord = resolveCoordinates( x, y );
     ( cl->*callback )( button, state, relativeCoord[ 0 ], relativeCoord[ 1 ] );
   };
+  if( m_headless )
+    return 0;
   glutMouseFunc( &CWindow::mouseButtonEventHandler );
   return 0;
 }
@@ -298,6 +448,8 @@ CWindow::registerMotionButtonEvent( type *cl, void(type::*callback)( int, int )
     TVector<2> relativeCoord = resolveCoordinates( x, y );
     ( cl->*callback )( relativeCoord[ 0 ], relativeCoord[ 1 ] );
   };
+  if( m_headless )
+    return 0;
   glutMotionFunc( &CWindow::mouseMotionEventHandler );
   return 0;
 }